@@ -1,10 +1,23 @@
 #include "bot_controller.h"
 #include <iostream>
 #include <cstdio>
+#include <ctime>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 
 BotController::BotController(const char* server_ip, int server_port)
-    : networkClient(server_ip, server_port), isRunning(true), 
-      messageCounter(1), updateInterval(30000) {
+    : networkClient(server_ip, server_port), processMonitor(5), isRunning(true), 
+      messageCounter(1), updateInterval(30000), sampleInterval(1000),
+      lastIdleTime(0), lastTotalTime(0), startTime((long long)time(NULL)), lastReportTime(0),
+      lastCpuPercent(0.0f), lastAvailableMemory(0.0f), primaryHasSystemInfo(false),
+      reconnectScheduled(false), nextReconnectTime(0) {
+    cpuMetric = metricStore.addMetric("cpu_percent");
+    memoryMetric = metricStore.addMetric("memory_available_mb");
+    memoryLoadMetric = metricStore.addMetric("memory_load_percent");
 }
 
 BotController::~BotController() {
@@ -16,6 +29,16 @@ bool BotController::initialize() {
         std::cerr << "ERROR: Failed to initialize network client" << std::endl;
         return false;
     }
+
+    // The bot shares the host with production work; stay out of its way
+    if (!governor.applyLowPriority()) {
+        std::cerr << "WARNING: Could not lower process priority" << std::endl;
+    }
+
+    // Local health checks read this; the bot still runs without it
+    if (!statsExport.open()) {
+        std::cerr << "WARNING: Shared-memory stats are unavailable" << std::endl;
+    }
     return true;
 }
 
@@ -43,21 +66,45 @@ void BotController::run() {
     std::cout << "System information collected:" << std::endl;
     std::cout << systemInfo << std::endl;
 
+    // Prime per-process state so the first status update has CPU deltas
+    processMonitor.sample();
+
+    // Report immediately, then every updateInterval; metrics are sampled in between
+    DWORD lastReport = GetTickCount() - updateInterval;
+
     while (isRunning) {
+        sampleMetrics();
+        if (governor.update(networkClient.getTotalBytesSent())) {
+            if (!governor.allowProcessCollector()) {
+                processMonitor.clear();
+            } else if (processMonitor.getProcessCount() == 0) {
+                // Re-enabled after a clear: prime again, or the next report shows 0% everywhere
+                processMonitor.sample();
+            }
+        }
+        publishStats();
+
+        // Reports keep going to the mirrors while the primary is down
         if (!networkClient.isConnected()) {
             handleReconnection();
-            continue;
         }
 
-        // Send system information on first connection
-        if (messageCounter == 1) {
-            sendSystemInfo();
-        } else {
-            sendStatusUpdate();
+        if (GetTickCount() - lastReport >= (DWORD)updateInterval) {
+            // Send system information on first connection
+            if (messageCounter == 1) {
+                sendSystemInfo(true);
+            } else {
+                // Refresh the RTT estimate that sizes timeouts and sends
+                networkClient.probeLink();
+                sendStatusUpdate();
+            }
+
+            messageCounter++;
+            lastReport = GetTickCount();
+            lastReportTime = (long long)time(NULL);
         }
 
-        messageCounter++;
-        Sleep(updateInterval);
+        waitForNextSample(governor.getSampleInterval(sampleInterval));
     }
 }
 
@@ -67,29 +114,164 @@ void BotController::stop() {
     std::cout << "Bot client stopped." << std::endl;
 }
 
+void BotController::addMirror(const std::string& ip, int port) {
+    networkClient.addMirror(ip, port);
+}
+
+bool BotController::startCapture(const std::string& path) {
+    return networkClient.startCapture(path);
+}
+
+void BotController::setResourceBudget(const ResourceBudget& budget) {
+    governor.setBudget(budget);
+}
+
+const ResourceBudget& BotController::getResourceBudget() const {
+    return governor.getBudget();
+}
+
 void BotController::setUpdateInterval(int seconds) {
     updateInterval = seconds * 1000; // Convert to milliseconds
 }
 
-void BotController::sendSystemInfo() {
+void BotController::sampleMetrics() {
+    float values[3] = { 0.0f, 0.0f, 0.0f };
+
+    // CPU usage is a delta, so the first reading (or one after a failed call)
+    // only primes the counters
+    bool haveCpu = false;
+    unsigned long long idleTime, totalTime;
+    if (SystemInfo::getCpuTimes(idleTime, totalTime)) {
+        unsigned long long totalDelta = totalTime - lastTotalTime;
+        if (lastTotalTime != 0 && totalDelta > 0) {
+            values[cpuMetric] = (float)(100.0 * (double)(totalDelta - (idleTime - lastIdleTime)) / (double)totalDelta);
+            haveCpu = true;
+        }
+        lastIdleTime = idleTime;
+        lastTotalTime = totalTime;
+    } else {
+        lastTotalTime = 0;
+    }
+
+    unsigned long long availableBytes;
+    unsigned long loadPercent;
+    bool haveMemory = SystemInfo::getMemoryStatus(availableBytes, loadPercent);
+    if (haveMemory) {
+        values[memoryMetric] = (float)(availableBytes / (1024 * 1024));
+        values[memoryLoadMetric] = (float)loadPercent;
+    }
+
+    // Samples are stored for all metrics at once; a zero standing in for a
+    // missing reading would drag down min, avg and percentiles, so skip it
+    if (!haveCpu || !haveMemory) {
+        return;
+    }
+
+    metricStore.addSample((long long)time(NULL), values);
+    lastCpuPercent = values[cpuMetric];
+    lastAvailableMemory = values[memoryMetric];
+}
+
+void BotController::publishStats() {
+    if (!statsExport.isOpen()) return;
+
+    const NetworkCounters& counters = networkClient.getCounters();
+    const LinkEstimator& link = networkClient.getLinkEstimator();
+
+    BotStats stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.processId = GetCurrentProcessId();
+    stats.connected = networkClient.isConnected() ? 1 : 0;
+    strncpy(stats.serverAddress, networkClient.getServerAddress().c_str(), sizeof(stats.serverAddress) - 1);
+    stats.serverPort = networkClient.getServerPort();
+    stats.queueDepth = (uint32_t)networkClient.getQueueDepth();
+    stats.startTime = startTime;
+    stats.lastReportTime = lastReportTime;
+    stats.reportsSent = messageCounter - 1;
+    stats.messagesSent = counters.messagesSent;
+    stats.bytesSent = counters.bytesSent;
+    stats.bytesReceived = counters.bytesReceived;
+    stats.sendErrors = counters.sendErrors;
+    stats.receiveErrors = counters.receiveErrors;
+    stats.receiveTimeouts = counters.receiveTimeouts;
+    stats.reconnects = counters.connections > 0 ? counters.connections - 1 : 0;
+    stats.smoothedRttMs = link.getSmoothedRtt();
+    stats.bandwidthBytesPerSecond = link.getBandwidth();
+    stats.cpuPercent = lastCpuPercent;
+    stats.availableMemoryMb = lastAvailableMemory;
+    stats.agentCpuPercent = governor.getCpuPercent();
+    stats.agentRssBytes = governor.getRssBytes();
+    stats.governorLevel = governor.getLevel();
+
+    statsExport.publish(stats);
+}
+
+std::string BotController::getMetricSummary() {
+    // Aggregates over the last report interval come straight from local history
+    long long now = (long long)time(NULL) + 1;
+    long long from = now - updateInterval / 1000;
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+
+    MetricAggregate cpu, memory;
+    if (metricStore.aggregate(cpuMetric, from, now, cpu)) {
+        ss << "CPU avg " << cpu.average() << "% max " << cpu.max << "%";
+    }
+    if (metricStore.aggregate(memoryMetric, from, now, memory)) {
+        ss << " | Available RAM min " << memory.min << " MB";
+    }
+
+    return ss.str();
+}
+
+void BotController::sendSystemInfo(bool fanOut) {
     std::string systemInfo = SystemInfo::getSystemInformation();
     std::string message = "SYSTEM_INFO:" + systemInfo;
-    networkClient.sendMessage(message.c_str());
-    networkClient.receiveResponse();
+    networkClient.sendMessage(message.c_str(), fanOut);
+    primaryHasSystemInfo = networkClient.receiveResponse();
+    handleServerCommands();
 }
 
 void BotController::sendStatusUpdate() {
     char statusMsg[256];
     sprintf(statusMsg, "STATUS_UPDATE: Bot running - Message #%d | Version: %s", 
             messageCounter, SystemInfo::getVersion().c_str());
-    networkClient.sendMessage(statusMsg);
+
+    std::string message = statusMsg;
+    if (governor.allowDetailedReports()) {
+        message += " | " + getMetricSummary();
+        const LinkEstimator& link = networkClient.getLinkEstimator();
+        if (link.hasRttEstimate()) {
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision(1) << " | RTT " << link.getSmoothedRtt() << " ms";
+            message += ss.str();
+        }
+    }
+    // Lowest-priority collector: the first thing shed under resource pressure
+    if (governor.allowProcessCollector() && processMonitor.sample()) {
+        message += " | " + processMonitor.getReport();
+    }
+    networkClient.sendMessage(message.c_str());
     networkClient.receiveResponse();
+    handleServerCommands();
 }
 
 void BotController::handleServerCommands() {
-    // Check for server commands in the response
-    // This would be implemented based on server response format
-    // For now, we'll add a placeholder for update command handling
+    // UPDATE commands are handled by NetworkClient as lines are read. QUERY
+    // commands are answered here from local history; waiting for one answer
+    // to be acknowledged may read another query, so keep going until none
+    // are pending.
+    std::vector<std::string> queries = networkClient.takeQueries();
+    while (!queries.empty()) {
+        for (const auto& query : queries) {
+            std::string result = processQueryCommand(query);
+            // Query answers belong to the primary that asked, not the mirrors
+            networkClient.sendMessage(result.c_str(), false);
+            networkClient.receiveResponse();
+        }
+        queries = networkClient.takeQueries();
+    }
 }
 
 void BotController::processUpdateCommand(const std::string& command) {
@@ -114,11 +296,126 @@ void BotController::processUpdateCommand(const std::string& command) {
     }
 }
 
+std::string BotController::processQueryCommand(const std::string& command) {
+    // Format: QUERY:<id>:<metric>:<aggregate>:<windowSeconds>[:<threshold>]
+    std::vector<std::string> fields;
+    std::stringstream parser(command);
+    std::string field;
+    while (std::getline(parser, field, ':')) {
+        if (!field.empty() && field[field.size() - 1] == '\r') {
+            field.erase(field.size() - 1);
+        }
+        fields.push_back(field);
+    }
+
+    std::string queryId = fields.size() > 1 ? fields[1] : "";
+    std::string prefix = "QUERY_RESULT:" + queryId + ":";
+    if (fields.size() < 5) {
+        return prefix + "ERROR:malformed query";
+    }
+
+    std::cout << "Received query " << queryId << " from server" << std::endl;
+
+    int metric = metricStore.findMetric(fields[2]);
+    if (metric < 0) {
+        return prefix + "ERROR:unknown metric " + fields[2];
+    }
+
+    long long window = atoll(fields[4].c_str());
+    if (window <= 0) {
+        return prefix + "ERROR:invalid window";
+    }
+
+    long long now = (long long)time(NULL) + 1;
+    long long from = now - window;
+    const std::string& aggregate = fields[3];
+
+    double value = 0.0;
+    unsigned long samples = 0;
+
+    if (aggregate == "avg" || aggregate == "min" || aggregate == "max" ||
+        aggregate == "sum" || aggregate == "count") {
+        MetricAggregate result;
+        if (metricStore.aggregate(metric, from, now, result)) {
+            samples = result.count;
+            if (aggregate == "avg") value = result.average();
+            else if (aggregate == "min") value = result.min;
+            else if (aggregate == "max") value = result.max;
+            else if (aggregate == "sum") value = result.sum;
+            else value = (double)result.count;
+        }
+    } else if (aggregate == "above") {
+        if (fields.size() < 6) {
+            return prefix + "ERROR:missing threshold";
+        }
+        // Threshold counts need individual samples, so only raw history is used
+        unsigned long above = 0;
+        samples = (unsigned long)metricStore.countAbove(metric, from, now, (float)atof(fields[5].c_str()), above);
+        value = (double)above;
+    } else if (aggregate.size() > 1 && aggregate[0] == 'p') {
+        double percentile = atof(aggregate.c_str() + 1);
+        if (percentile <= 0.0 || percentile > 100.0) {
+            return prefix + "ERROR:invalid percentile";
+        }
+        std::vector<float> values;
+        samples = (unsigned long)metricStore.copySamples(metric, from, now, values);
+        if (samples > 0) {
+            // Nearest-rank percentile; nth_element avoids sorting the whole window
+            size_t rank = (size_t)std::ceil(percentile / 100.0 * samples);
+            size_t index = rank > 0 ? rank - 1 : 0;
+            std::nth_element(values.begin(), values.begin() + index, values.end());
+            value = values[index];
+        }
+    } else {
+        return prefix + "ERROR:unknown aggregate " + aggregate;
+    }
+
+    std::stringstream ss;
+    ss << prefix << std::fixed << std::setprecision(2) << value << ":" << samples;
+    return ss.str();
+}
+
+void BotController::waitForNextSample(int milliseconds) {
+    // Sleep until the next sample, but answer queries the server pushes in
+    // the meantime instead of holding them until the next report
+    DWORD start = GetTickCount();
+    while (isRunning) {
+        DWORD elapsed = GetTickCount() - start;
+        if (elapsed >= (DWORD)milliseconds) {
+            break;
+        }
+        if (!networkClient.isConnected()) {
+            Sleep(milliseconds - elapsed);
+            break;
+        }
+        networkClient.pollServer(milliseconds - elapsed);
+        handleServerCommands();
+    }
+}
+
 void BotController::handleReconnection() {
-    std::cout << "Reconnecting in 5 seconds..." << std::endl;
-    Sleep(5000);
-    
+    // Called every sample while disconnected; attempts are scheduled rather
+    // than slept on so sampling and mirror reports carry on in between
+    if (!reconnectScheduled) {
+        int delay = networkClient.getReconnectDelay();
+        std::cout << "Reconnecting in " << delay << " ms..." << std::endl;
+        nextReconnectTime = GetTickCount() + delay;
+        reconnectScheduled = true;
+        return;
+    }
+    if ((int)(GetTickCount() - nextReconnectTime) < 0) {
+        return;
+    }
+    reconnectScheduled = false;
+
     if (!networkClient.connectToServer()) {
         std::cout << "Reconnection failed, will retry..." << std::endl;
+        return;
+    }
+
+    // The first report may have gone only to the mirrors; the mirrors
+    // already have it, so the primary gets its own copy
+    if (!primaryHasSystemInfo && messageCounter > 1) {
+        sendSystemInfo(false);
     }
 } 
\ No newline at end of file
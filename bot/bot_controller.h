@@ -3,15 +3,37 @@
 
 #include "network_client.h"
 #include "system_info.h"
+#include "process_monitor.h"
+#include "metric_store.h"
+#include "stats_export.h"
+#include "resource_governor.h"
 #include <string>
+#include <vector>
 #include <windows.h>
 
 class BotController {
 private:
     NetworkClient networkClient;
+    ProcessMonitor processMonitor;
+    MetricStore metricStore;
+    StatsExport statsExport;
+    ResourceGovernor governor;
     bool isRunning;
     int messageCounter;
     int updateInterval;
+    int sampleInterval;
+    int cpuMetric;
+    int memoryMetric;
+    int memoryLoadMetric;
+    unsigned long long lastIdleTime;
+    unsigned long long lastTotalTime;
+    long long startTime;
+    long long lastReportTime;
+    float lastCpuPercent;
+    float lastAvailableMemory;
+    bool primaryHasSystemInfo;      // SYSTEM_INFO was acknowledged by the primary
+    bool reconnectScheduled;
+    DWORD nextReconnectTime;
 
 public:
     BotController(const char* server_ip = "127.0.0.1", int server_port = 5555);
@@ -22,13 +44,22 @@ public:
     void run();
     void stop();
     void setUpdateInterval(int seconds);
+    void addMirror(const std::string& ip, int port);
+    void setResourceBudget(const ResourceBudget& budget);
+    bool startCapture(const std::string& path);
+    const ResourceBudget& getResourceBudget() const;
     
 private:
-    void sendSystemInfo();
+    void sampleMetrics();
+    std::string getMetricSummary();
+    void publishStats();
+    void sendSystemInfo(bool fanOut);
     void sendStatusUpdate();
     void handleReconnection();
     void handleServerCommands();
+    void waitForNextSample(int milliseconds);
     void processUpdateCommand(const std::string& command);
+    std::string processQueryCommand(const std::string& command);
 };
 
 #endif // BOT_CONTROLLER_H 
\ No newline at end of file
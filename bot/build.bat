@@ -3,23 +3,27 @@ echo Building Modular TCP Bot Client...
 
 where g++ >nul 2>nul
 if %errorlevel% equ 0 (
-    g++ main.cpp system_info.cpp network_client.cpp bot_controller.cpp -o modular_bot.exe -lws2_32 -lwininet
+    g++ main.cpp system_info.cpp network_client.cpp bot_controller.cpp process_monitor.cpp metric_store.cpp link_estimator.cpp stats_export.cpp collector_session.cpp resource_governor.cpp trace_file.cpp reply_framing.cpp -o modular_bot.exe -lws2_32 -lwininet -lpsapi
     if %errorlevel% equ 0 (
         echo Build successful! Created modular_bot.exe
     ) else (
         echo Build failed!
     )
+    g++ stats_reader.cpp -o bot_stats.exe
+    g++ trace_replay.cpp trace_file.cpp reply_framing.cpp -o trace_replay.exe -lws2_32
     goto :end
 )
 
 where cl >nul 2>nul
 if %errorlevel% equ 0 (
-    cl main.cpp system_info.cpp network_client.cpp bot_controller.cpp /EHsc /Fe:modular_bot.exe
+    cl main.cpp system_info.cpp network_client.cpp bot_controller.cpp process_monitor.cpp metric_store.cpp link_estimator.cpp stats_export.cpp collector_session.cpp resource_governor.cpp trace_file.cpp reply_framing.cpp /EHsc /Fe:modular_bot.exe
     if %errorlevel% equ 0 (
         echo Build successful! Created modular_bot.exe
     ) else (
         echo Build failed!
     )
+    cl stats_reader.cpp /EHsc /Fe:bot_stats.exe
+    cl trace_replay.cpp trace_file.cpp reply_framing.cpp /EHsc /Fe:trace_replay.exe ws2_32.lib
     goto :end
 )
 
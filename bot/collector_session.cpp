@@ -0,0 +1,184 @@
+#include "collector_session.h"
+#include "reply_framing.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+const int MIN_RECONNECT_DELAY_MS = 1000;
+const int MAX_RECONNECT_DELAY_MS = 60000;
+const DWORD MIRROR_RECEIVE_TIMEOUT_MS = 10000;
+
+} // namespace
+
+CollectorSession::CollectorSession(const std::string& address, int port, size_t maxQueued)
+    : address(address), port(port), sock(INVALID_SOCKET), maxQueued(maxQueued),
+      reconnectDelay(MIN_RECONNECT_DELAY_MS), running(false), enqueued(0), delivered(0), dropped(0), bytesSent(0) {
+}
+
+CollectorSession::~CollectorSession() {
+    stop();
+}
+
+void CollectorSession::start() {
+    std::lock_guard<std::mutex> lock(queueLock);
+    if (running) return;
+    running = true;
+    worker = std::thread(&CollectorSession::run, this);
+}
+
+void CollectorSession::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        if (!running) return;
+        running = false;
+    }
+    queueReady.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    closeSocket();
+}
+
+void CollectorSession::enqueue(const SharedMessage& message) {
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        // Never block the caller: when the mirror falls behind, shed its oldest backlog
+        if (queue.size() >= maxQueued) {
+            queue.pop_front();
+            dropped++;
+        }
+        queue.push_back(message);
+        enqueued++;
+    }
+    queueReady.notify_one();
+}
+
+bool CollectorSession::isConnected() const {
+    return sock != INVALID_SOCKET;
+}
+
+size_t CollectorSession::getQueueDepth() const {
+    std::lock_guard<std::mutex> lock(queueLock);
+    return queue.size();
+}
+
+unsigned long long CollectorSession::getDeliveredCount() const {
+    std::lock_guard<std::mutex> lock(queueLock);
+    return delivered;
+}
+
+unsigned long long CollectorSession::getDroppedCount() const {
+    std::lock_guard<std::mutex> lock(queueLock);
+    return dropped;
+}
+
+unsigned long long CollectorSession::getBytesSent() const {
+    std::lock_guard<std::mutex> lock(queueLock);
+    return bytesSent;
+}
+
+std::string CollectorSession::getName() const {
+    return address + ":" + std::to_string(port);
+}
+
+void CollectorSession::run() {
+    std::unique_lock<std::mutex> lock(queueLock);
+
+    while (running) {
+        queueReady.wait(lock, [this] { return !running || !queue.empty(); });
+        if (!running) break;
+
+        // The front message stays queued until the collector acknowledges it,
+        // so a reconnect resumes from the same spool position.
+        SharedMessage message = queue.front();
+        lock.unlock();
+
+        bool sent = (sock != INVALID_SOCKET || connectToCollector()) && deliver(*message);
+
+        lock.lock();
+        if (sent) {
+            if (!queue.empty() && queue.front() == message) {
+                queue.pop_front();
+            }
+            delivered++;
+            bytesSent += message->size();
+            reconnectDelay = MIN_RECONNECT_DELAY_MS;
+        } else {
+            // Back off without holding up anyone else; stop() wakes us early
+            queueReady.wait_for(lock, std::chrono::milliseconds(reconnectDelay), [this] { return !running; });
+            reconnectDelay = std::min(reconnectDelay * 2, MAX_RECONNECT_DELAY_MS);
+        }
+    }
+}
+
+bool CollectorSession::connectToCollector() {
+    sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == INVALID_SOCKET) {
+        return false;
+    }
+
+    struct sockaddr_in collector;
+    collector.sin_family = AF_INET;
+    collector.sin_port = htons(port);
+    collector.sin_addr.s_addr = inet_addr(address.c_str());
+
+    if (connect(sock, (struct sockaddr*)&collector, sizeof(collector)) < 0) {
+        std::cerr << "ERROR: Mirror " << getName() << " connection failed" << std::endl;
+        closeSocket();
+        return false;
+    }
+
+    DWORD timeout = MIRROR_RECEIVE_TIMEOUT_MS;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    std::cout << "Connected to mirror " << getName() << std::endl;
+    return true;
+}
+
+bool CollectorSession::deliver(const std::string& message) {
+    size_t sent = 0;
+    while (sent < message.size()) {
+        int result = send(sock, message.data() + sent, (int)(message.size() - sent), 0);
+        if (result == SOCKET_ERROR) {
+            std::cerr << "ERROR: Failed to send to mirror " << getName() << std::endl;
+            closeSocket();
+            return false;
+        }
+        sent += result;
+    }
+
+    // The collector acknowledges each read it makes, so the message is
+    // delivered once the acknowledged byte counts cover all of it. Commands
+    // are only taken from the primary; pushed lines are discarded.
+    size_t unacknowledged = message.size();
+    while (true) {
+        std::string line;
+        while (unacknowledged > 0 && takeLine(readBuffer, line)) {
+            size_t acknowledged;
+            if (parseAck(line, acknowledged)) {
+                unacknowledged -= std::min(acknowledged, unacknowledged);
+            }
+        }
+        if (unacknowledged == 0) {
+            return true;
+        }
+
+        char buffer[4096];
+        int len = recv(sock, buffer, sizeof(buffer), 0);
+        if (len <= 0) {
+            std::cerr << "ERROR: No reply from mirror " << getName() << std::endl;
+            closeSocket();
+            return false;
+        }
+        readBuffer.append(buffer, len);
+    }
+}
+
+void CollectorSession::closeSocket() {
+    if (sock != INVALID_SOCKET) {
+        closesocket(sock);
+        sock = INVALID_SOCKET;
+    }
+    readBuffer.clear();
+}
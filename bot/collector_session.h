@@ -0,0 +1,60 @@
+#ifndef COLLECTOR_SESSION_H
+#define COLLECTOR_SESSION_H
+
+#include <winsock2.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// A report encoded once and shared by every session that still has to send it
+typedef std::shared_ptr<const std::string> SharedMessage;
+
+// Delivery to one mirror collector on its own thread. Each session has its
+// own bounded queue, connection and reconnect backoff, so a slow or dead
+// mirror only ever affects itself.
+class CollectorSession {
+private:
+    std::string address;
+    int port;
+    SOCKET sock;
+    std::string readBuffer;     // Reply bytes not yet split into lines
+    size_t maxQueued;
+    int reconnectDelay;
+    bool running;
+
+    std::thread worker;
+    mutable std::mutex queueLock;
+    std::condition_variable queueReady;
+    std::deque<SharedMessage> queue;
+
+    // Spool position: messages handed to this session, delivered and dropped
+    unsigned long long enqueued;
+    unsigned long long delivered;
+    unsigned long long dropped;
+    unsigned long long bytesSent;
+
+public:
+    CollectorSession(const std::string& address, int port, size_t maxQueued = 256);
+    ~CollectorSession();
+
+    void start();
+    void stop();
+    void enqueue(const SharedMessage& message);
+    bool isConnected() const;
+    size_t getQueueDepth() const;
+    unsigned long long getDeliveredCount() const;
+    unsigned long long getDroppedCount() const;
+    unsigned long long getBytesSent() const;
+    std::string getName() const;
+
+private:
+    void run();
+    bool connectToCollector();
+    bool deliver(const std::string& message);
+    void closeSocket();
+};
+
+#endif // COLLECTOR_SESSION_H
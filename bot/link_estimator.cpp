@@ -0,0 +1,121 @@
+#include "link_estimator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+// Defaults match the values the client used before it measured anything
+const int DEFAULT_RECEIVE_TIMEOUT_MS = 30000;
+// Replies also wait on the collector, not just the link; a LAN round trip
+// says nothing about how long a busy collector takes to answer.
+const int MIN_RECEIVE_TIMEOUT_MS = 5000;
+const int DEFAULT_CONNECT_TIMEOUT_MS = 5000;
+const int MIN_RECONNECT_DELAY_MS = 1000;
+
+// Below this a transfer is mostly latency. Status updates are usually
+// smaller, so the bandwidth estimate only moves once larger messages such as
+// system information have been sent; those are also the only ones whose
+// receive timeout it noticeably stretches.
+const size_t MIN_TRANSFER_SAMPLE_BYTES = 4 * 1024;
+
+// Assumed until a large message has been timed: a slow WAN uplink
+const double FALLBACK_BANDWIDTH = 16.0 * 1024;
+const int MAX_TRANSFER_ALLOWANCE_MS = 120000;
+
+int clampTimeout(double value, int low, int high) {
+    return (int)std::min<double>(std::max<double>(value, low), high);
+}
+
+} // namespace
+
+LinkEstimator::LinkEstimator()
+    : smoothedRtt(0.0), rttVariance(0.0), bandwidth(0.0), hasRtt(false), hasBandwidth(false) {
+}
+
+void LinkEstimator::addRttSample(double rttMs) {
+    if (rttMs < 0.0) {
+        return;
+    }
+
+    if (!hasRtt) {
+        smoothedRtt = rttMs;
+        rttVariance = rttMs / 2.0;
+        hasRtt = true;
+    } else {
+        rttVariance = 0.75 * rttVariance + 0.25 * std::fabs(smoothedRtt - rttMs);
+        smoothedRtt = 0.875 * smoothedRtt + 0.125 * rttMs;
+    }
+}
+
+void LinkEstimator::addTransferSample(size_t bytes, double elapsedMs) {
+    // Small messages are dominated by latency and say nothing about throughput
+    if (bytes < MIN_TRANSFER_SAMPLE_BYTES || !hasRtt) {
+        return;
+    }
+
+    // Time beyond one round trip is what it took to push the payload
+    double transferMs = std::max(elapsedMs - smoothedRtt, 1.0);
+    double sample = bytes * 1000.0 / transferMs;
+
+    if (!hasBandwidth) {
+        bandwidth = sample;
+        hasBandwidth = true;
+    } else {
+        bandwidth = 0.8 * bandwidth + 0.2 * sample;
+    }
+}
+
+bool LinkEstimator::hasRttEstimate() const {
+    return hasRtt;
+}
+
+double LinkEstimator::getSmoothedRtt() const {
+    return smoothedRtt;
+}
+
+double LinkEstimator::getRttVariance() const {
+    return rttVariance;
+}
+
+double LinkEstimator::getBandwidth() const {
+    return bandwidth;
+}
+
+int LinkEstimator::getReceiveTimeout(size_t bytesInFlight) const {
+    // The server answers every message, so a reply should arrive within a
+    // retransmission timeout plus server processing slack...
+    int timeout = DEFAULT_RECEIVE_TIMEOUT_MS;
+    if (hasRtt) {
+        timeout = clampTimeout(4.0 * (smoothedRtt + 4.0 * rttVariance) + 1000.0,
+                               MIN_RECEIVE_TIMEOUT_MS, DEFAULT_RECEIVE_TIMEOUT_MS);
+    }
+
+    // ...plus the time the link needs to carry what is still unacknowledged
+    double rate = hasBandwidth ? bandwidth : FALLBACK_BANDWIDTH;
+    return timeout + clampTimeout(bytesInFlight * 1000.0 / rate, 0, MAX_TRANSFER_ALLOWANCE_MS);
+}
+
+int LinkEstimator::getConnectTimeout() const {
+    if (!hasRtt) {
+        return DEFAULT_CONNECT_TIMEOUT_MS;
+    }
+    // A handshake is one round trip; allow for a SYN retransmission
+    return clampTimeout(3.0 * (smoothedRtt + 4.0 * rttVariance) + 250.0, 250, DEFAULT_CONNECT_TIMEOUT_MS);
+}
+
+int LinkEstimator::getReconnectDelay(unsigned int failures, int maxDelay) const {
+    // Exponential backoff like the mirror sessions, so a fleet does not hammer
+    // a collector that is down. A slow link only raises the starting point.
+    double delay = MIN_RECONNECT_DELAY_MS;
+    if (hasRtt) {
+        delay = std::max(delay, 10.0 * (smoothedRtt + 4.0 * rttVariance));
+    }
+    delay *= std::pow(2.0, (double)std::min(failures, 16u));
+    return clampTimeout(delay, MIN_RECONNECT_DELAY_MS, maxDelay);
+}
+
+double LinkEstimator::now() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
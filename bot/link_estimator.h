@@ -0,0 +1,34 @@
+#ifndef LINK_ESTIMATOR_H
+#define LINK_ESTIMATOR_H
+
+#include <cstddef>
+
+// Smoothed round-trip time and throughput of the link to the server, used to
+// size timeouts instead of fixed constants. RTT smoothing follows
+// the TCP retransmission timer (RFC 6298).
+class LinkEstimator {
+private:
+    double smoothedRtt;     // Milliseconds
+    double rttVariance;     // Milliseconds
+    double bandwidth;       // Bytes per second
+    bool hasRtt;
+    bool hasBandwidth;
+
+public:
+    LinkEstimator();
+
+    void addRttSample(double rttMs);
+    void addTransferSample(size_t bytes, double elapsedMs);
+    bool hasRttEstimate() const;
+    double getSmoothedRtt() const;
+    double getRttVariance() const;
+    double getBandwidth() const;
+
+    int getReceiveTimeout(size_t bytesInFlight = 0) const;
+    int getConnectTimeout() const;
+    int getReconnectDelay(unsigned int failures, int maxDelay) const;
+
+    static double now();
+};
+
+#endif // LINK_ESTIMATOR_H
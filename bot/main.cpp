@@ -1,7 +1,9 @@
 #include "bot_controller.h"
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 
-int main() {
+int main(int argc, char* argv[]) {
     std::cout << "=== Remote Activity Bot ===" << std::endl;
     std::cout << "Starting UDP server discovery..." << std::endl;
     
@@ -12,6 +14,31 @@ int main() {
         std::cerr << "Failed to initialize bot" << std::endl;
         return 1;
     }
+
+    // Optional settings:
+    //   --mirror <ip>:<port>        extra collector (repeatable)
+    //   --cpu-budget <percent>      own CPU budget, percent of one core
+    //   --memory-budget <MB>        own resident memory budget
+    //   --bandwidth-budget <B/s>    outbound bandwidth budget
+    //   --capture <file>            record wire traffic for trace_replay
+    ResourceBudget budget = bot.getResourceBudget();
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--mirror") == 0) {
+            std::string target = argv[++i];
+            size_t colon = target.find(':');
+            int port = colon != std::string::npos ? atoi(target.c_str() + colon + 1) : 5555;
+            bot.addMirror(target.substr(0, colon), port);
+        } else if (strcmp(argv[i], "--cpu-budget") == 0) {
+            budget.cpuPercent = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--memory-budget") == 0) {
+            budget.rssBytes = strtoull(argv[++i], NULL, 10) * 1024 * 1024;
+        } else if (strcmp(argv[i], "--bandwidth-budget") == 0) {
+            budget.bytesPerSecond = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--capture") == 0) {
+            bot.startCapture(argv[++i]);
+        }
+    }
+    bot.setResourceBudget(budget);
     
     // Try to discover servers using UDP broadcast
     if (bot.discoverAndConnect()) {
@@ -0,0 +1,454 @@
+#include "metric_store.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define METRIC_STORE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+void initAggregate(MetricAggregate& acc) {
+    acc.min = std::numeric_limits<float>::infinity();
+    acc.max = -std::numeric_limits<float>::infinity();
+    acc.sum = 0.0;
+    acc.count = 0;
+}
+
+// min/max/sum over raw samples, four lanes at a time
+void reduceValues(const float* values, size_t count, MetricAggregate& acc) {
+    size_t i = 0;
+    float minValue = acc.min;
+    float maxValue = acc.max;
+    double sum = 0.0;
+
+#ifdef METRIC_STORE_SSE2
+    if (count >= 4) {
+        __m128 vmin = _mm_set1_ps(minValue);
+        __m128 vmax = _mm_set1_ps(maxValue);
+        __m128d sumLow = _mm_setzero_pd();
+        __m128d sumHigh = _mm_setzero_pd();
+
+        for (; i + 4 <= count; i += 4) {
+            __m128 v = _mm_loadu_ps(values + i);
+            vmin = _mm_min_ps(vmin, v);
+            vmax = _mm_max_ps(vmax, v);
+            // Widen to double before summing so long windows keep their precision
+            sumLow = _mm_add_pd(sumLow, _mm_cvtps_pd(v));
+            sumHigh = _mm_add_pd(sumHigh, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+        }
+
+        float mins[4], maxs[4];
+        double sums[2];
+        _mm_storeu_ps(mins, vmin);
+        _mm_storeu_ps(maxs, vmax);
+        _mm_storeu_pd(sums, _mm_add_pd(sumLow, sumHigh));
+        for (int lane = 0; lane < 4; lane++) {
+            minValue = std::min(minValue, mins[lane]);
+            maxValue = std::max(maxValue, maxs[lane]);
+        }
+        sum = sums[0] + sums[1];
+    }
+#endif
+
+    for (; i < count; i++) {
+        minValue = std::min(minValue, values[i]);
+        maxValue = std::max(maxValue, values[i]);
+        sum += values[i];
+    }
+
+    acc.min = minValue;
+    acc.max = maxValue;
+    acc.sum += sum;
+    acc.count += (unsigned long)count;
+}
+
+// Combines already rolled-up buckets: min of mins, max of maxes, sum of sums
+void reduceBuckets(const float* mins, const float* maxs, const double* sums,
+                   const unsigned int* counts, size_t count, MetricAggregate& acc) {
+    size_t i = 0;
+    float minValue = acc.min;
+    float maxValue = acc.max;
+    double sum = 0.0;
+    unsigned long samples = 0;
+
+#ifdef METRIC_STORE_SSE2
+    if (count >= 4) {
+        __m128 vmin = _mm_set1_ps(minValue);
+        __m128 vmax = _mm_set1_ps(maxValue);
+        __m128d vsum = _mm_setzero_pd();
+
+        for (; i + 4 <= count; i += 4) {
+            vmin = _mm_min_ps(vmin, _mm_loadu_ps(mins + i));
+            vmax = _mm_max_ps(vmax, _mm_loadu_ps(maxs + i));
+            vsum = _mm_add_pd(vsum, _mm_add_pd(_mm_loadu_pd(sums + i), _mm_loadu_pd(sums + i + 2)));
+            samples += counts[i] + counts[i + 1] + counts[i + 2] + counts[i + 3];
+        }
+
+        float laneMins[4], laneMaxs[4];
+        double laneSums[2];
+        _mm_storeu_ps(laneMins, vmin);
+        _mm_storeu_ps(laneMaxs, vmax);
+        _mm_storeu_pd(laneSums, vsum);
+        for (int lane = 0; lane < 4; lane++) {
+            minValue = std::min(minValue, laneMins[lane]);
+            maxValue = std::max(maxValue, laneMaxs[lane]);
+        }
+        sum = laneSums[0] + laneSums[1];
+    }
+#endif
+
+    for (; i < count; i++) {
+        minValue = std::min(minValue, mins[i]);
+        maxValue = std::max(maxValue, maxs[i]);
+        sum += sums[i];
+        samples += counts[i];
+    }
+
+    acc.min = minValue;
+    acc.max = maxValue;
+    acc.sum += sum;
+    acc.count += samples;
+}
+
+// Counts samples strictly greater than threshold, four lanes at a time
+unsigned long countGreater(const float* values, size_t count, float threshold) {
+    size_t i = 0;
+    unsigned long above = 0;
+
+#ifdef METRIC_STORE_SSE2
+    static const unsigned char maskBits[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+    __m128 vthreshold = _mm_set1_ps(threshold);
+    for (; i + 4 <= count; i += 4) {
+        above += maskBits[_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(values + i), vthreshold))];
+    }
+#endif
+
+    for (; i < count; i++) {
+        if (values[i] > threshold) {
+            above++;
+        }
+    }
+    return above;
+}
+
+// Splits a logical [first, first + count) range of a ring into at most two
+// physical spans; the second span (if any) starts at index 0.
+void ringSpans(size_t capacity, size_t head, size_t size, size_t first, size_t count,
+               size_t& start, size_t& firstSpan) {
+    start = (head + capacity - size + first) % capacity;
+    firstSpan = std::min(count, capacity - start);
+}
+
+// Smallest multiple of step at or after value (timestamps are non-negative)
+long long ceilToMultiple(long long value, long long step) {
+    return (value + step - 1) / step * step;
+}
+
+} // namespace
+
+double MetricAggregate::average() const {
+    return count > 0 ? sum / count : 0.0;
+}
+
+MetricStore::MetricStore(size_t rawSeconds, size_t minuteBuckets, size_t hourBuckets)
+    : rawCapacity(rawSeconds), rawHead(0), rawSize(0),
+      pendingRaw(0), pendingMinutes(0), currentMinute(0), currentHour(0) {
+    rawTimestamps.resize(rawCapacity);
+
+    minuteTier.bucketSeconds = 60;
+    minuteTier.capacity = minuteBuckets;
+    hourTier.bucketSeconds = 3600;
+    hourTier.capacity = hourBuckets;
+
+    resizeTier(minuteTier);
+    resizeTier(hourTier);
+}
+
+int MetricStore::addMetric(const std::string& name) {
+    // Layout is fixed once sampling starts
+    if (rawSize > 0 || minuteTier.size > 0) {
+        return -1;
+    }
+
+    int existing = findMetric(name);
+    if (existing >= 0) {
+        return existing;
+    }
+
+    metricNames.push_back(name);
+    rawValues.resize(metricNames.size() * rawCapacity);
+    resizeTier(minuteTier);
+    resizeTier(hourTier);
+    return (int)metricNames.size() - 1;
+}
+
+int MetricStore::findMetric(const std::string& name) const {
+    for (size_t i = 0; i < metricNames.size(); i++) {
+        if (metricNames[i] == name) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+size_t MetricStore::getMetricCount() const {
+    return metricNames.size();
+}
+
+void MetricStore::addSample(long long timestamp, const float* values) {
+    long long minute = timestamp / 60;
+    long long hour = timestamp / 3600;
+
+    // Close finished buckets before the new sample lands in the raw ring
+    if (pendingRaw > 0 && minute != currentMinute) {
+        rollupMinute();
+    }
+    if (pendingMinutes > 0 && hour != currentHour) {
+        rollupHour();
+    }
+    currentMinute = minute;
+    currentHour = hour;
+
+    rawTimestamps[rawHead] = timestamp;
+    for (size_t m = 0; m < metricNames.size(); m++) {
+        rawValues[m * rawCapacity + rawHead] = values[m];
+    }
+
+    rawHead = (rawHead + 1) % rawCapacity;
+    rawSize = std::min(rawSize + 1, rawCapacity);
+    pendingRaw = std::min(pendingRaw + 1, rawCapacity);
+}
+
+bool MetricStore::aggregate(int metric, long long fromTime, long long toTime, MetricAggregate& result) const {
+    initAggregate(result);
+    if (metric < 0 || metric >= (int)metricNames.size() || fromTime >= toTime) {
+        return false;
+    }
+
+    // Each tier answers for [its own boundary, the next finer tier's boundary),
+    // so no sample is counted twice. A finer tier answers alone when it reaches
+    // back to fromTime; otherwise it takes over at the first coarser bucket
+    // boundary that has been rolled up, so the bucket straddling its oldest
+    // sample comes from the coarser tier instead of being lost.
+    long long rawFrom = std::numeric_limits<long long>::max();
+    if (rawSize > 0) {
+        rawFrom = rawTimestamps[(rawHead + rawCapacity - rawSize) % rawCapacity];
+    }
+    long long minuteFrom = rawFrom;
+    if (minuteTier.size > 0) {
+        size_t newest = (minuteTier.head + minuteTier.capacity - 1) % minuteTier.capacity;
+        size_t oldest = (minuteTier.head + minuteTier.capacity - minuteTier.size) % minuteTier.capacity;
+        minuteFrom = minuteTier.timestamps[oldest];
+        if (rawSize > 0 && fromTime < rawFrom) {
+            rawFrom = std::min(ceilToMultiple(rawFrom, minuteTier.bucketSeconds),
+                               minuteTier.timestamps[newest] + minuteTier.bucketSeconds);
+        }
+    }
+    if (hourTier.size > 0 && fromTime < minuteFrom) {
+        size_t newest = (hourTier.head + hourTier.capacity - 1) % hourTier.capacity;
+        minuteFrom = std::min(ceilToMultiple(minuteFrom, hourTier.bucketSeconds),
+                              hourTier.timestamps[newest] + hourTier.bucketSeconds);
+    }
+    minuteFrom = std::min(minuteFrom, rawFrom);
+
+    const Tier* tiers[2] = { &hourTier, &minuteTier };
+    long long lower[2] = { fromTime, std::max(fromTime, minuteFrom) };
+    long long upper[2] = { std::min(toTime, minuteFrom), std::min(toTime, rawFrom) };
+
+    for (int t = 0; t < 2; t++) {
+        const Tier& tier = *tiers[t];
+        if (tier.size == 0 || lower[t] >= upper[t]) {
+            continue;
+        }
+
+        // A bucket belongs to the range its midpoint falls in, so windows that
+        // cut through a bucket are off by at most half a bucket either way
+        long long half = tier.bucketSeconds / 2;
+        size_t first = lowerBound(tier.timestamps, tier.capacity, tier.head, tier.size, lower[t] - half);
+        size_t last = lowerBound(tier.timestamps, tier.capacity, tier.head, tier.size, upper[t] - half);
+        if (last <= first) {
+            continue;
+        }
+
+        size_t start, firstSpan;
+        size_t count = last - first;
+        ringSpans(tier.capacity, tier.head, tier.size, first, count, start, firstSpan);
+
+        size_t base = metric * tier.capacity;
+        reduceBuckets(&tier.minValues[base + start], &tier.maxValues[base + start], &tier.sums[base + start],
+                      &tier.counts[start], firstSpan, result);
+        if (count > firstSpan) {
+            reduceBuckets(&tier.minValues[base], &tier.maxValues[base], &tier.sums[base],
+                          &tier.counts[0], count - firstSpan, result);
+        }
+    }
+
+    size_t start, firstSpan, count;
+    if (rawRange(std::max(fromTime, rawFrom), toTime, start, firstSpan, count)) {
+        const float* ring = &rawValues[metric * rawCapacity];
+        reduceValues(ring + start, firstSpan, result);
+        if (count > firstSpan) {
+            reduceValues(ring, count - firstSpan, result);
+        }
+    }
+
+    return result.count > 0;
+}
+
+size_t MetricStore::copySamples(int metric, long long fromTime, long long toTime, std::vector<float>& out) const {
+    out.clear();
+    size_t start, firstSpan, count;
+    if (metric < 0 || metric >= (int)metricNames.size() || !rawRange(fromTime, toTime, start, firstSpan, count)) {
+        return 0;
+    }
+
+    const float* ring = &rawValues[metric * rawCapacity];
+    out.assign(ring + start, ring + start + firstSpan);
+    out.insert(out.end(), ring, ring + (count - firstSpan));
+    return count;
+}
+
+size_t MetricStore::countAbove(int metric, long long fromTime, long long toTime, float threshold,
+                               unsigned long& above) const {
+    above = 0;
+    size_t start, firstSpan, count;
+    if (metric < 0 || metric >= (int)metricNames.size() || !rawRange(fromTime, toTime, start, firstSpan, count)) {
+        return 0;
+    }
+
+    const float* ring = &rawValues[metric * rawCapacity];
+    above = countGreater(ring + start, firstSpan, threshold) + countGreater(ring, count - firstSpan, threshold);
+    return count;
+}
+
+size_t MetricStore::getMemoryUsage() const {
+    size_t bytes = rawTimestamps.size() * sizeof(long long) + rawValues.size() * sizeof(float);
+
+    const Tier* tiers[2] = { &minuteTier, &hourTier };
+    for (const Tier* tier : tiers) {
+        bytes += tier->timestamps.size() * sizeof(long long) + tier->counts.size() * sizeof(unsigned int) +
+                 tier->minValues.size() * sizeof(float) * 2 + tier->sums.size() * sizeof(double);
+    }
+    return bytes;
+}
+
+bool MetricStore::rawRange(long long fromTime, long long toTime, size_t& start, size_t& firstSpan, size_t& count) const {
+    if (rawSize == 0 || fromTime >= toTime) {
+        return false;
+    }
+
+    size_t first = lowerBound(rawTimestamps, rawCapacity, rawHead, rawSize, fromTime);
+    size_t last = lowerBound(rawTimestamps, rawCapacity, rawHead, rawSize, toTime);
+    if (last <= first) {
+        return false;
+    }
+
+    count = last - first;
+    ringSpans(rawCapacity, rawHead, rawSize, first, count, start, firstSpan);
+    return true;
+}
+
+void MetricStore::resizeTier(Tier& tier) {
+    size_t metrics = metricNames.size();
+    tier.head = 0;
+    tier.size = 0;
+    tier.timestamps.resize(tier.capacity);
+    tier.counts.resize(tier.capacity);
+    tier.minValues.resize(metrics * tier.capacity);
+    tier.maxValues.resize(metrics * tier.capacity);
+    tier.sums.resize(metrics * tier.capacity);
+}
+
+void MetricStore::rollupMinute() {
+    size_t metrics = metricNames.size();
+    std::vector<float> mins(metrics), maxs(metrics);
+    std::vector<double> sums(metrics);
+
+    size_t start, firstSpan;
+    ringSpans(rawCapacity, rawHead, rawSize, rawSize - pendingRaw, pendingRaw, start, firstSpan);
+
+    for (size_t m = 0; m < metrics; m++) {
+        MetricAggregate acc;
+        initAggregate(acc);
+
+        const float* ring = &rawValues[m * rawCapacity];
+        reduceValues(ring + start, firstSpan, acc);
+        if (pendingRaw > firstSpan) {
+            reduceValues(ring, pendingRaw - firstSpan, acc);
+        }
+
+        mins[m] = acc.min;
+        maxs[m] = acc.max;
+        sums[m] = acc.sum;
+    }
+
+    pushBucket(minuteTier, currentMinute * 60, (unsigned int)pendingRaw, mins.data(), maxs.data(), sums.data());
+    pendingRaw = 0;
+    pendingMinutes = std::min(pendingMinutes + 1, minuteTier.capacity);
+}
+
+void MetricStore::rollupHour() {
+    size_t metrics = metricNames.size();
+    std::vector<float> mins(metrics), maxs(metrics);
+    std::vector<double> sums(metrics);
+    unsigned long samples = 0;
+
+    size_t start, firstSpan;
+    ringSpans(minuteTier.capacity, minuteTier.head, minuteTier.size,
+              minuteTier.size - pendingMinutes, pendingMinutes, start, firstSpan);
+
+    for (size_t m = 0; m < metrics; m++) {
+        MetricAggregate acc;
+        initAggregate(acc);
+
+        size_t base = m * minuteTier.capacity;
+        reduceBuckets(&minuteTier.minValues[base + start], &minuteTier.maxValues[base + start],
+                      &minuteTier.sums[base + start], &minuteTier.counts[start], firstSpan, acc);
+        if (pendingMinutes > firstSpan) {
+            reduceBuckets(&minuteTier.minValues[base], &minuteTier.maxValues[base], &minuteTier.sums[base],
+                          &minuteTier.counts[0], pendingMinutes - firstSpan, acc);
+        }
+
+        mins[m] = acc.min;
+        maxs[m] = acc.max;
+        sums[m] = acc.sum;
+        samples = acc.count;
+    }
+
+    pushBucket(hourTier, currentHour * 3600, (unsigned int)samples, mins.data(), maxs.data(), sums.data());
+    pendingMinutes = 0;
+}
+
+void MetricStore::pushBucket(Tier& tier, long long bucketStart, unsigned int count,
+                             const float* mins, const float* maxs, const double* sums) {
+    tier.timestamps[tier.head] = bucketStart;
+    tier.counts[tier.head] = count;
+    for (size_t m = 0; m < metricNames.size(); m++) {
+        size_t index = m * tier.capacity + tier.head;
+        tier.minValues[index] = mins[m];
+        tier.maxValues[index] = maxs[m];
+        tier.sums[index] = sums[m];
+    }
+
+    tier.head = (tier.head + 1) % tier.capacity;
+    tier.size = std::min(tier.size + 1, tier.capacity);
+}
+
+size_t MetricStore::lowerBound(const std::vector<long long>& timestamps, size_t capacity,
+                               size_t head, size_t size, long long value) {
+    // Binary search over logical (oldest-first) positions of the ring
+    size_t oldest = (head + capacity - size) % capacity;
+    size_t low = 0;
+    size_t high = size;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (timestamps[(oldest + mid) % capacity] < value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
@@ -0,0 +1,70 @@
+#ifndef METRIC_STORE_H
+#define METRIC_STORE_H
+
+#include <string>
+#include <vector>
+
+struct MetricAggregate {
+    float min;
+    float max;
+    double sum;
+    unsigned long count;
+
+    double average() const;
+};
+
+// Fixed-memory time-series history. Every metric owns one contiguous ring per
+// tier (structure-of-arrays), so rollups and queries run over plain float
+// arrays. Raw 1 s samples roll up into 1 min buckets, and those into 1 h.
+class MetricStore {
+private:
+    struct Tier {
+        long long bucketSeconds;
+        size_t capacity;
+        size_t head;                        // Next slot to write
+        size_t size;
+        std::vector<long long> timestamps;  // Bucket start, shared by all metrics
+        std::vector<unsigned int> counts;   // Samples per bucket, shared by all metrics
+        std::vector<float> minValues;       // metricCount rings of `capacity` each
+        std::vector<float> maxValues;
+        std::vector<double> sums;
+    };
+
+    std::vector<std::string> metricNames;
+    size_t rawCapacity;
+    size_t rawHead;
+    size_t rawSize;
+    std::vector<long long> rawTimestamps;
+    std::vector<float> rawValues;           // metricCount rings of `rawCapacity` each
+    Tier minuteTier;
+    Tier hourTier;
+    size_t pendingRaw;                      // Raw samples not yet rolled into a minute
+    size_t pendingMinutes;                  // Minute buckets not yet rolled into an hour
+    long long currentMinute;
+    long long currentHour;
+
+public:
+    MetricStore(size_t rawSeconds = 3600, size_t minuteBuckets = 1440, size_t hourBuckets = 168);
+
+    int addMetric(const std::string& name);
+    int findMetric(const std::string& name) const;
+    size_t getMetricCount() const;
+    void addSample(long long timestamp, const float* values);
+    bool aggregate(int metric, long long fromTime, long long toTime, MetricAggregate& result) const;
+    size_t copySamples(int metric, long long fromTime, long long toTime, std::vector<float>& out) const;
+    size_t countAbove(int metric, long long fromTime, long long toTime, float threshold,
+                      unsigned long& above) const;
+    size_t getMemoryUsage() const;
+
+private:
+    bool rawRange(long long fromTime, long long toTime, size_t& start, size_t& firstSpan, size_t& count) const;
+    void resizeTier(Tier& tier);
+    void rollupMinute();
+    void rollupHour();
+    void pushBucket(Tier& tier, long long bucketStart, unsigned int count,
+                    const float* mins, const float* maxs, const double* sums);
+    static size_t lowerBound(const std::vector<long long>& timestamps, size_t capacity,
+                             size_t head, size_t size, long long value);
+};
+
+#endif // METRIC_STORE_H
@@ -1,17 +1,24 @@
 #include "network_client.h"
 #include "system_info.h"
+#include "reply_framing.h"
 #include <iostream>
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <sstream>
+#include <cstring>
 #include <ws2tcpip.h>
 
 NetworkClient::NetworkClient(const char* ip, int port) 
-    : sock(INVALID_SOCKET), discoverySocket(INVALID_SOCKET), server_ip((char*)ip), server_port(port), 
-      isRunning(true), reconnectDelay(5000), discoveryMode(false) {
+    : sock(INVALID_SOCKET), discoverySocket(INVALID_SOCKET), server_ip(ip), server_port(port), 
+      isRunning(true), reconnectDelay(60000), connectFailures(0), discoveryMode(false),
+      pingSequence(0), pendingSendBytes(0), pendingSendTime(0.0), unacknowledgedBytes(0) {
+    memset(&counters, 0, sizeof(counters));
 }
 
 NetworkClient::~NetworkClient() {
+    // Mirror threads use Winsock, so they must finish before WSACleanup
+    mirrors.clear();
     disconnect();
     cleanupDiscoverySocket();
     WSACleanup();
@@ -25,15 +32,13 @@ bool NetworkClient::initialize() {
 
     server.sin_family = AF_INET;
     server.sin_port = htons(server_port);
-    server.sin_addr.s_addr = inet_addr(server_ip);
+    server.sin_addr.s_addr = inet_addr(server_ip.c_str());
 
     return true;
 }
 
 bool NetworkClient::connectToServer() {
-    if (sock != INVALID_SOCKET) {
-        closesocket(sock);
-    }
+    closeConnection();
 
     sock = socket(AF_INET, SOCK_STREAM, 0);
     if (sock == INVALID_SOCKET) {
@@ -42,69 +47,324 @@ bool NetworkClient::connectToServer() {
     }
 
     std::cout << "Attempting to connect to " << server_ip << ":" << server_port << "..." << std::endl;
+    connectFailures++;
 
-    if (connect(sock, (struct sockaddr*)&server, sizeof(server)) < 0) {
+    if (!connectWithTimeout(linkEstimator.getConnectTimeout())) {
         std::cerr << "ERROR: Connection failed - server may be down" << std::endl;
         closesocket(sock);
         sock = INVALID_SOCKET;
         return false;
     }
 
+    applySocketTimeouts();
+    counters.connections++;
+    capture.record(TRACE_CONNECTED, NULL, 0);
     std::cout << "Connected successfully!" << std::endl;
     return true;
 }
 
-void NetworkClient::sendMessage(const char* message) {
+void NetworkClient::sendMessage(const char* message, bool fanOut) {
+    // Encode once; mirrors share the same buffer instead of copying it.
+    // They get every report even while the primary is down.
+    SharedMessage shared = std::make_shared<const std::string>(message);
+    if (fanOut) {
+        for (auto& mirror : mirrors) {
+            mirror->enqueue(shared);
+        }
+    }
+    if (sock == INVALID_SOCKET) return;
+
+    // send() may accept only part of a large report
+    message = shared->c_str();
+    size_t length = shared->size();
+    size_t sent = 0;
+    double startTime = LinkEstimator::now();
+
+    while (sent < length) {
+        int result = send(sock, message + sent, (int)(length - sent), 0);
+        if (result == SOCKET_ERROR) {
+            counters.sendErrors++;
+            std::cerr << "ERROR: Failed to send message" << std::endl;
+            closeConnection();
+            return;
+        }
+        sent += result;
+    }
+
+    // The server acknowledges every read with the byte count it got, so the
+    // message is confirmed once acknowledgements cover all of it
+    capture.record(TRACE_SENT, message, length);
+    if (unacknowledgedBytes == 0) {
+        pendingSendBytes = length;
+        pendingSendTime = startTime;
+    }
+    unacknowledgedBytes += length;
+    counters.messagesSent++;
+    counters.bytesSent += length;
+    std::cout << "Message sent: " << message << std::endl;
+}
+
+bool NetworkClient::receiveResponse() {
+    // Wait until the server has acknowledged everything sent so far; pushed
+    // commands that arrive in between are dispatched on the way. A large
+    // message gets longer, since the link has to carry it first.
+    applySocketTimeouts(unacknowledgedBytes);
+    while (sock != INVALID_SOCKET) {
+        std::string line;
+        while (takeLine(readBuffer, line)) {
+            dispatchLine(line);
+        }
+        if (unacknowledgedBytes == 0) {
+            return true;
+        }
+        if (!readIntoBuffer()) {
+            break;
+        }
+    }
+    return false;
+}
+
+void NetworkClient::disconnect() {
+    closeConnection();
+}
+
+bool NetworkClient::isConnected() const {
+    return sock != INVALID_SOCKET;
+}
+
+void NetworkClient::setReconnectDelay(int delay) {
+    reconnectDelay = delay;
+}
+
+int NetworkClient::getReconnectDelay() const {
+    return linkEstimator.getReconnectDelay(connectFailures, reconnectDelay);
+}
+
+const LinkEstimator& NetworkClient::getLinkEstimator() const {
+    return linkEstimator;
+}
+
+const NetworkCounters& NetworkClient::getCounters() const {
+    return counters;
+}
+
+const std::string& NetworkClient::getServerAddress() const {
+    return server_ip;
+}
+
+int NetworkClient::getServerPort() const {
+    return server_port;
+}
+
+bool NetworkClient::probeLink() {
+    if (sock == INVALID_SOCKET) return false;
+
+    unsigned int sequence = ++pingSequence;
+    double sendTime = LinkEstimator::now();
+
+    std::stringstream ping;
+    ping << "PING:" << sequence << ":" << (long long)sendTime;
+    std::string message = ping.str();
+    if (send(sock, message.c_str(), (int)message.size(), 0) == SOCKET_ERROR) {
+        counters.sendErrors++;
+        std::cerr << "ERROR: Failed to send ping" << std::endl;
+        closeConnection();
+        return false;
+    }
+    capture.record(TRACE_SENT, message.c_str(), message.size());
+    counters.bytesSent += message.size();
+
+    // Read lines until our own pong shows up. Anything queued ahead of it
+    // (late acknowledgements, pushed commands) is dispatched as usual, and a
+    // pong from an earlier probe is ignored.
+    std::string expected = "PONG:" + std::to_string(sequence) + ":";
+    while (sock != INVALID_SOCKET) {
+        std::string line;
+        while (takeLine(readBuffer, line)) {
+            if (line.compare(0, expected.size(), expected) == 0) {
+                linkEstimator.addRttSample(LinkEstimator::now() - sendTime);
+                applySocketTimeouts();
+                return true;
+            }
+            if (line.compare(0, 5, "PONG:") != 0) {
+                dispatchLine(line);
+            }
+        }
+        if (!readIntoBuffer()) {
+            break;
+        }
+    }
+    return false;
+}
+
+bool NetworkClient::pollServer(int waitMs) {
+    // Read whatever the server pushed between reports, waiting at most waitMs
+    // for the first byte so idle time doubles as query latency
+    while (sock != INVALID_SOCKET) {
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(sock, &readSet);
+        struct timeval timeout;
+        timeout.tv_sec = waitMs / 1000;
+        timeout.tv_usec = (waitMs % 1000) * 1000;
+        if (select(0, &readSet, NULL, NULL, &timeout) <= 0) {
+            break;
+        }
+        if (!readIntoBuffer()) {
+            return false;
+        }
+        waitMs = 0;
+    }
+
+    std::string line;
+    while (takeLine(readBuffer, line)) {
+        dispatchLine(line);
+    }
+    return sock != INVALID_SOCKET;
+}
+
+std::vector<std::string> NetworkClient::takeQueries() {
+    std::vector<std::string> queries;
+    queries.swap(pendingQueries);
+    return queries;
+}
+
+bool NetworkClient::connectWithTimeout(int timeoutMs) {
+    // Non-blocking connect so an unreachable server costs a bounded wait
+    unsigned long nonBlocking = 1;
+    ioctlsocket(sock, FIONBIO, &nonBlocking);
+
+    bool connected = connect(sock, (struct sockaddr*)&server, sizeof(server)) == 0;
+    if (!connected && WSAGetLastError() == WSAEWOULDBLOCK) {
+        fd_set writeSet, errorSet;
+        FD_ZERO(&writeSet);
+        FD_ZERO(&errorSet);
+        FD_SET(sock, &writeSet);
+        FD_SET(sock, &errorSet);
+
+        struct timeval timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_usec = (timeoutMs % 1000) * 1000;
+
+        if (select(0, NULL, &writeSet, &errorSet, &timeout) > 0 && FD_ISSET(sock, &writeSet)) {
+            int error = 0;
+            int errorLength = sizeof(error);
+            connected = getsockopt(sock, SOL_SOCKET, SO_ERROR, (char*)&error, &errorLength) == 0 && error == 0;
+        }
+    }
+
+    unsigned long blocking = 0;
+    ioctlsocket(sock, FIONBIO, &blocking);
+    return connected;
+}
+
+void NetworkClient::applySocketTimeouts(size_t bytesInFlight) {
     if (sock == INVALID_SOCKET) return;
 
-    if (send(sock, message, strlen(message), 0) == SOCKET_ERROR) {
-        std::cerr << "ERROR: Failed to send message" << std::endl;
+    DWORD timeout = (DWORD)linkEstimator.getReceiveTimeout(bytesInFlight);
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+}
+
+void NetworkClient::closeConnection() {
+    if (sock != INVALID_SOCKET) {
         closesocket(sock);
         sock = INVALID_SOCKET;
-    } else {
-        std::cout << "Message sent: " << message << std::endl;
     }
+    // Nothing read on the old connection can be matched on a new one
+    readBuffer.clear();
+    unacknowledgedBytes = 0;
+    pendingSendBytes = 0;
 }
 
-void NetworkClient::receiveResponse() {
-    if (sock == INVALID_SOCKET) return;
+bool NetworkClient::readIntoBuffer() {
+    char buffer[4096];
+    int len = recv(sock, buffer, sizeof(buffer), 0);
 
-    char buffer[1024];
-    int len = recv(sock, buffer, sizeof(buffer) - 1, 0);
-    
     if (len > 0) {
-        buffer[len] = 0;
-        std::string response(buffer);
-        std::cout << "Server response: " << response << std::endl;
-
-        // Check if the server sent an update command within the response
-        // This also covers cases where the server pushed an UPDATE command
-        // outside of the normal request/response flow and it was read here.
-        handleUpdateCommand(response);
-    } else if (len == 0) {
+        counters.bytesReceived += len;
+        capture.record(TRACE_RECEIVED, buffer, len);
+        readBuffer.append(buffer, len);
+        return true;
+    }
+
+    if (len == 0) {
         std::cout << "Server closed connection" << std::endl;
-        closesocket(sock);
-        sock = INVALID_SOCKET;
+    } else if (WSAGetLastError() == WSAETIMEDOUT) {
+        // The socket state after an SO_RCVTIMEO timeout is undefined, so
+        // start over on a fresh connection
+        std::cerr << "WARNING: Timed out waiting for server response" << std::endl;
+        counters.receiveTimeouts++;
     } else {
+        counters.receiveErrors++;
         std::cerr << "ERROR: Failed to receive response" << std::endl;
-        closesocket(sock);
-        sock = INVALID_SOCKET;
     }
+    closeConnection();
+    return false;
 }
 
-void NetworkClient::disconnect() {
-    if (sock != INVALID_SOCKET) {
-        closesocket(sock);
-        sock = INVALID_SOCKET;
+void NetworkClient::dispatchLine(const std::string& line) {
+    size_t acknowledged;
+    if (parseAck(line, acknowledged)) {
+        // Only a server that answers ends the backoff; one that accepts and
+        // drops connections keeps backing off
+        connectFailures = 0;
+        unacknowledgedBytes -= std::min(acknowledged, unacknowledgedBytes);
+        if (unacknowledgedBytes == 0 && pendingSendBytes > 0) {
+            // Timed against the reply that confirms the whole message
+            linkEstimator.addTransferSample(pendingSendBytes, LinkEstimator::now() - pendingSendTime);
+            pendingSendBytes = 0;
+        }
+        std::cout << "Server response: " << line << std::endl;
+    } else if (line.compare(0, 6, "QUERY:") == 0) {
+        pendingQueries.push_back(line);
+    } else if (line.compare(0, 7, "UPDATE:") == 0) {
+        handleUpdateCommand(line);
+    } else if (!line.empty()) {
+        std::cout << "Server response: " << line << std::endl;
     }
 }
 
-bool NetworkClient::isConnected() const {
-    return sock != INVALID_SOCKET;
+void NetworkClient::addMirror(const std::string& ip, int port) {
+    std::unique_ptr<CollectorSession> mirror(new CollectorSession(ip, port));
+    mirror->start();
+    std::cout << "Mirroring reports to " << mirror->getName() << std::endl;
+    mirrors.push_back(std::move(mirror));
 }
 
-void NetworkClient::setReconnectDelay(int delay) {
-    reconnectDelay = delay;
+size_t NetworkClient::getMirrorCount() const {
+    return mirrors.size();
+}
+
+size_t NetworkClient::getQueueDepth() const {
+    size_t depth = 0;
+    for (const auto& mirror : mirrors) {
+        depth += mirror->getQueueDepth();
+    }
+    return depth;
+}
+
+unsigned long long NetworkClient::getTotalBytesSent() const {
+    unsigned long long bytes = counters.bytesSent;
+    for (const auto& mirror : mirrors) {
+        bytes += mirror->getBytesSent();
+    }
+    return bytes;
+}
+
+bool NetworkClient::startCapture(const std::string& path) {
+    if (!capture.open(path)) {
+        return false;
+    }
+    std::cout << "Capturing wire traffic to " << path << std::endl;
+    // Replays need a connection to start from
+    if (sock != INVALID_SOCKET) {
+        capture.record(TRACE_CONNECTED, NULL, 0);
+    }
+    return true;
+}
+
+void NetworkClient::stopCapture() {
+    capture.close();
 }
 
 // Server discovery methods
@@ -158,8 +418,8 @@ bool NetworkClient::connectToDiscoveredServer() {
     std::cout << "Connecting to discovered server: " << bestServer << std::endl;
     
     // Update server IP and reconnect
-    server_ip = (char*)bestServer.c_str();
-    server.sin_addr.s_addr = inet_addr(server_ip);
+    server_ip = bestServer;
+    server.sin_addr.s_addr = inet_addr(server_ip.c_str());
     
     return connectToServer();
 }
@@ -4,6 +4,20 @@
 #include <winsock2.h>
 #include <string>
 #include <vector>
+#include "link_estimator.h"
+#include "collector_session.h"
+#include "trace_file.h"
+#include <memory>
+
+struct NetworkCounters {
+    unsigned long long messagesSent;
+    unsigned long long bytesSent;
+    unsigned long long bytesReceived;
+    unsigned long long sendErrors;
+    unsigned long long receiveErrors;
+    unsigned long long receiveTimeouts;
+    unsigned long long connections;
+};
 
 class NetworkClient {
 private:
@@ -11,26 +25,64 @@ private:
     SOCKET sock;
     SOCKET discoverySocket;
     struct sockaddr_in server;
-    char* server_ip;
+    std::string server_ip;
     int server_port;
     bool isRunning;
-    int reconnectDelay;
+    int reconnectDelay;             // Ceiling for the reconnect backoff
+    unsigned int connectFailures;   // Connect attempts since the server last answered
     
     // Discovery related members
     std::vector<std::string> discoveredServers;
     bool discoveryMode;
 
+    // Link measurement
+    LinkEstimator linkEstimator;
+    unsigned int pingSequence;
+    size_t pendingSendBytes;
+    double pendingSendTime;
+    NetworkCounters counters;
+
+    // Replies are newline-framed; bytes read but not yet split into lines
+    // are kept per connection, and pushed queries wait for the controller.
+    std::string readBuffer;
+    size_t unacknowledgedBytes;
+    std::vector<std::string> pendingQueries;
+
+    // Mirror collectors that receive a copy of every report
+    std::vector<std::unique_ptr<CollectorSession>> mirrors;
+
+    // Optional wire-traffic capture for replay benchmarks
+    TraceWriter capture;
+
 public:
     NetworkClient(const char* ip = "127.0.0.1", int port = 5555);
     ~NetworkClient();
     
     bool initialize();
     bool connectToServer();
-    void sendMessage(const char* message);
-    void receiveResponse();
+    void sendMessage(const char* message, bool fanOut = true);
+    bool receiveResponse();
     void disconnect();
     bool isConnected() const;
     void setReconnectDelay(int delay);
+    int getReconnectDelay() const;
+    bool probeLink();
+    bool pollServer(int waitMs);
+    std::vector<std::string> takeQueries();
+    const LinkEstimator& getLinkEstimator() const;
+    const NetworkCounters& getCounters() const;
+    const std::string& getServerAddress() const;
+    int getServerPort() const;
+
+    // Mirror collectors
+    void addMirror(const std::string& ip, int port);
+    size_t getMirrorCount() const;
+    size_t getQueueDepth() const;
+    unsigned long long getTotalBytesSent() const;
+
+    // Wire-traffic capture
+    bool startCapture(const std::string& path);
+    void stopCapture();
     
     // Server discovery methods
     bool discoverServers(int timeoutSeconds = 10);
@@ -45,6 +97,11 @@ public:
     void performSelfUpdate(const std::string& newExePath);
     
 private:
+    bool connectWithTimeout(int timeoutMs);
+    void applySocketTimeouts(size_t bytesInFlight = 0);
+    void closeConnection();
+    bool readIntoBuffer();
+    void dispatchLine(const std::string& line);
     bool initializeDiscoverySocket();
     void cleanupDiscoverySocket();
     bool sendDiscoveryBroadcast();
@@ -0,0 +1,379 @@
+#include "process_monitor.h"
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <winternl.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#endif
+
+#ifndef _WIN32
+namespace {
+
+// /proc has no bulk interface, so every pid read costs an open/read/close.
+// Processes that stayed idle are re-read only every IDLE_REREAD_SCANS scans,
+// staggered by pid so the re-reads are spread evenly; their CPU time is
+// cumulative, so the next read still accounts for everything in between.
+// A skipped entry is never older than IDLE_MAX_AGE_NS, so an idle process
+// that starts spinning shows up within that long. At the 30 s report
+// interval every pid is read on every scan; skipping only pays off when
+// scans are frequent.
+const unsigned int IDLE_SCANS_BEFORE_SKIP = 2;
+const unsigned int IDLE_REREAD_SCANS = 8;
+const unsigned long long IDLE_MAX_AGE_NS = 10ULL * 1000000000ULL;
+
+} // namespace
+#endif
+
+#ifdef _WIN32
+namespace {
+
+// Full layout of the SystemProcessInformation record. winternl.h hides most
+// of these fields behind Reserved arrays, so it is spelled out here.
+struct SystemProcessRecord {
+    ULONG NextEntryOffset;
+    ULONG NumberOfThreads;
+    LARGE_INTEGER WorkingSetPrivateSize;
+    ULONG HardFaultCount;
+    ULONG NumberOfThreadsHighWatermark;
+    ULONGLONG CycleTime;
+    LARGE_INTEGER CreateTime;
+    LARGE_INTEGER UserTime;
+    LARGE_INTEGER KernelTime;
+    UNICODE_STRING ImageName;
+    LONG BasePriority;
+    HANDLE UniqueProcessId;
+    HANDLE InheritedFromUniqueProcessId;
+    ULONG HandleCount;
+    ULONG SessionId;
+    ULONG_PTR UniqueProcessKey;
+    SIZE_T PeakVirtualSize;
+    SIZE_T VirtualSize;
+    ULONG PageFaultCount;
+    SIZE_T PeakWorkingSetSize;
+    SIZE_T WorkingSetSize;
+};
+
+typedef LONG (WINAPI *NtQuerySystemInformationFn)(ULONG, PVOID, ULONG, PULONG);
+
+const ULONG SYSTEM_PROCESS_INFORMATION_CLASS = 5;
+const LONG STATUS_INFO_LENGTH_MISMATCH_CODE = (LONG)0xC0000004L;
+
+NtQuerySystemInformationFn getNtQuerySystemInformation() {
+    static NtQuerySystemInformationFn fn = (NtQuerySystemInformationFn)GetProcAddress(
+        GetModuleHandleA("ntdll.dll"), "NtQuerySystemInformation");
+    return fn;
+}
+
+} // namespace
+#endif
+
+ProcessMonitor::ProcessMonitor(size_t topN)
+    : topCount(topN), scanNumber(0), cpuCount(getCpuCount()) {
+}
+
+bool ProcessMonitor::sample() {
+    scanNumber++;
+    if (!scanProcesses(getWallTime())) {
+        return false;
+    }
+
+    removeExitedProcesses();
+    rankProcesses();
+    return true;
+}
+
+const std::vector<ProcessUsage>& ProcessMonitor::getTopByCpu() const {
+    return topByCpu;
+}
+
+const std::vector<ProcessUsage>& ProcessMonitor::getTopByMemory() const {
+    return topByMemory;
+}
+
+size_t ProcessMonitor::getProcessCount() const {
+    return processes.size();
+}
+
+void ProcessMonitor::setTopCount(size_t topN) {
+    topCount = topN;
+}
+
+void ProcessMonitor::clear() {
+    // Release per-pid state and the scan buffer; the next sample starts fresh
+    std::unordered_map<unsigned long, ProcessState>().swap(processes);
+    std::vector<char>().swap(scanBuffer);
+    topByCpu.clear();
+    topByMemory.clear();
+}
+
+std::string ProcessMonitor::getReport() const {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+
+    ss << "Top CPU:";
+    for (size_t i = 0; i < topByCpu.size(); i++) {
+        ss << (i == 0 ? " " : ", ") << topByCpu[i].name << "(" << topByCpu[i].pid << ") "
+           << topByCpu[i].cpuPercent << "%";
+    }
+    ss << " | Top RSS:";
+    for (size_t i = 0; i < topByMemory.size(); i++) {
+        ss << (i == 0 ? " " : ", ") << topByMemory[i].name << "(" << topByMemory[i].pid << ") "
+           << (topByMemory[i].rssBytes / (1024 * 1024)) << " MB";
+    }
+
+    return ss.str();
+}
+
+ProcessMonitor::ProcessState& ProcessMonitor::trackProcess(unsigned long pid, unsigned long long startTime,
+                                                          unsigned long long cpuTime, unsigned long long rssBytes,
+                                                          unsigned long long now, bool& isNew) {
+    ProcessState& state = processes[pid];
+    isNew = state.lastSeenScan == 0 || state.startTime != startTime;
+
+    if (isNew) {
+        // First sighting (or pid reuse): there is no previous sample to diff against
+        state.startTime = startTime;
+        state.cpuPercent = 0.0;
+        state.idleScans = 0;
+    } else if (now > state.lastReadTime && cpuTime >= state.cpuTime) {
+        // Diff against this process's own last read, which may be several scans back
+        state.cpuPercent = (double)(cpuTime - state.cpuTime) * 100.0 /
+                           ((double)(now - state.lastReadTime) * cpuCount);
+        state.idleScans = cpuTime == state.cpuTime ? state.idleScans + 1 : 0;
+    }
+
+    state.cpuTime = cpuTime;
+    state.rssBytes = rssBytes;
+    state.lastReadTime = now;
+    state.lastSeenScan = scanNumber;
+    return state;
+}
+
+void ProcessMonitor::removeExitedProcesses() {
+    for (auto it = processes.begin(); it != processes.end(); ) {
+        if (it->second.lastSeenScan != scanNumber) {
+            it = processes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ProcessMonitor::rankProcesses() {
+    std::vector<std::pair<unsigned long, const ProcessState*>> ranked;
+    ranked.reserve(processes.size());
+    for (const auto& entry : processes) {
+        ranked.push_back(std::make_pair(entry.first, &entry.second));
+    }
+
+    size_t count = std::min(topCount, ranked.size());
+
+    auto fill = [&](std::vector<ProcessUsage>& out) {
+        out.clear();
+        for (size_t i = 0; i < count; i++) {
+            const ProcessState* state = ranked[i].second;
+            out.push_back(ProcessUsage{ranked[i].first, state->name, state->cpuPercent, state->rssBytes});
+        }
+    };
+
+    // partial_sort keeps ranking at O(n log N) instead of sorting every process
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+        [](const std::pair<unsigned long, const ProcessState*>& a,
+           const std::pair<unsigned long, const ProcessState*>& b) {
+            return a.second->cpuPercent > b.second->cpuPercent;
+        });
+    fill(topByCpu);
+
+    std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+        [](const std::pair<unsigned long, const ProcessState*>& a,
+           const std::pair<unsigned long, const ProcessState*>& b) {
+            return a.second->rssBytes > b.second->rssBytes;
+        });
+    fill(topByMemory);
+}
+
+#ifdef _WIN32
+
+bool ProcessMonitor::scanProcesses(unsigned long long now) {
+    NtQuerySystemInformationFn query = getNtQuerySystemInformation();
+    if (query == NULL) {
+        return false;
+    }
+
+    // One call returns every process with its times and working set, so no
+    // per-process handles are opened. The buffer is reused between scans.
+    if (scanBuffer.empty()) {
+        scanBuffer.resize(256 * 1024);
+    }
+
+    ULONG needed = 0;
+    LONG status;
+    while ((status = query(SYSTEM_PROCESS_INFORMATION_CLASS, scanBuffer.data(),
+                           (ULONG)scanBuffer.size(), &needed)) == STATUS_INFO_LENGTH_MISMATCH_CODE) {
+        // Leave headroom for processes started between the two calls
+        scanBuffer.resize(std::max<size_t>(needed, scanBuffer.size()) + 64 * 1024);
+    }
+    if (status < 0) {
+        return false;
+    }
+
+    const char* cursor = scanBuffer.data();
+    while (true) {
+        const SystemProcessRecord* record = (const SystemProcessRecord*)cursor;
+        unsigned long pid = (unsigned long)(ULONG_PTR)record->UniqueProcessId;
+
+        if (pid != 0) {
+            unsigned long long cpuTime = (unsigned long long)record->UserTime.QuadPart +
+                                         (unsigned long long)record->KernelTime.QuadPart;
+            bool isNew;
+            ProcessState& state = trackProcess(pid, (unsigned long long)record->CreateTime.QuadPart,
+                                               cpuTime, record->WorkingSetSize, now, isNew);
+
+            // Image names only need converting the first time a process is seen
+            if (isNew) {
+                if (record->ImageName.Buffer != NULL && record->ImageName.Length > 0) {
+                    int wideLength = record->ImageName.Length / sizeof(WCHAR);
+                    int length = WideCharToMultiByte(CP_UTF8, 0, record->ImageName.Buffer, wideLength,
+                                                     NULL, 0, NULL, NULL);
+                    state.name.assign(length, '\0');
+                    WideCharToMultiByte(CP_UTF8, 0, record->ImageName.Buffer, wideLength,
+                                        &state.name[0], length, NULL, NULL);
+                } else {
+                    state.name = "System";
+                }
+            }
+        }
+
+        if (record->NextEntryOffset == 0) {
+            break;
+        }
+        cursor += record->NextEntryOffset;
+    }
+
+    return true;
+}
+
+unsigned long long ProcessMonitor::getWallTime() {
+    // 100ns units, matching the process times reported by the kernel
+    FILETIME time;
+    GetSystemTimeAsFileTime(&time);
+    return ((unsigned long long)time.dwHighDateTime << 32) | time.dwLowDateTime;
+}
+
+unsigned int ProcessMonitor::getCpuCount() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
+#else
+
+bool ProcessMonitor::scanProcesses(unsigned long long now) {
+    static const long pageSize = sysconf(_SC_PAGESIZE);
+    static const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    const unsigned long long nsPerTick = 1000000000ULL / (ticksPerSecond > 0 ? ticksPerSecond : 100);
+
+    DIR* dir = opendir("/proc");
+    if (dir == NULL) {
+        return false;
+    }
+    int procFd = dirfd(dir);
+
+    if (scanBuffer.size() < 1024) {
+        scanBuffer.resize(1024);
+    }
+
+    char path[32];
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        const char* pidName = entry->d_name;
+        if (pidName[0] < '1' || pidName[0] > '9') {
+            continue;
+        }
+
+        // Still listed, so still alive; skip the read if it has been idle
+        unsigned long pid = strtoul(pidName, NULL, 10);
+        auto known = processes.find(pid);
+        if (known != processes.end() && known->second.idleScans >= IDLE_SCANS_BEFORE_SKIP &&
+            now - known->second.lastReadTime < IDLE_MAX_AGE_NS &&
+            (scanNumber + pid) % IDLE_REREAD_SCANS != 0) {
+            known->second.lastSeenScan = scanNumber;
+            continue;
+        }
+
+        // openat() relative to /proc avoids re-walking the directory for every pid
+        size_t pidLength = strlen(pidName);
+        if (pidLength + 6 > sizeof(path)) {
+            continue;
+        }
+        memcpy(path, pidName, pidLength);
+        memcpy(path + pidLength, "/stat", 6);
+
+        int fd = openat(procFd, path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            continue; // Process exited between readdir() and open()
+        }
+        ssize_t length = read(fd, scanBuffer.data(), scanBuffer.size() - 1);
+        close(fd);
+        if (length <= 0) {
+            continue;
+        }
+        scanBuffer[length] = 0;
+
+        // Format: pid (comm) state ppid ... ; comm may itself contain ')'
+        char* nameStart = strchr(scanBuffer.data(), '(');
+        char* nameEnd = strrchr(scanBuffer.data(), ')');
+        if (nameStart == NULL || nameEnd == NULL || nameEnd < nameStart) {
+            continue;
+        }
+
+        // Walk to fields 14 (utime), 15 (stime), 22 (starttime) and 24 (rss)
+        unsigned long long utime = 0, stime = 0, startTime = 0, rssPages = 0;
+        char* cursor = nameEnd + 2;
+        for (int field = 3; field <= 24 && *cursor; field++) {
+            char* next;
+            unsigned long long value = strtoull(cursor, &next, 10);
+            if (field == 14) utime = value;
+            else if (field == 15) stime = value;
+            else if (field == 22) startTime = value;
+            else if (field == 24) rssPages = value;
+
+            cursor = strchr(cursor, ' ');
+            if (cursor == NULL) break;
+            cursor++;
+        }
+
+        bool isNew;
+        ProcessState& state = trackProcess(pid, startTime, (utime + stime) * nsPerTick,
+                                           rssPages * (unsigned long long)pageSize, now, isNew);
+        if (isNew) {
+            state.name.assign(nameStart + 1, nameEnd - nameStart - 1);
+        }
+    }
+
+    closedir(dir);
+    return true;
+}
+
+unsigned long long ProcessMonitor::getWallTime() {
+    // Nanoseconds, matching the tick-converted CPU times above
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+unsigned int ProcessMonitor::getCpuCount() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (unsigned int)count : 1;
+}
+
+#endif
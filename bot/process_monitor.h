@@ -0,0 +1,59 @@
+#ifndef PROCESS_MONITOR_H
+#define PROCESS_MONITOR_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+struct ProcessUsage {
+    unsigned long pid;
+    std::string name;
+    double cpuPercent;
+    unsigned long long rssBytes;
+};
+
+class ProcessMonitor {
+private:
+    // Per-pid state kept between scans so each sample only needs a delta
+    struct ProcessState {
+        unsigned long long startTime;   // Distinguishes a reused pid from the original process
+        unsigned long long cpuTime;     // Cumulative CPU time, same unit as getWallTime()
+        unsigned long long rssBytes;
+        unsigned long long lastReadTime;    // Wall time of the sample cpuTime came from
+        double cpuPercent;
+        unsigned int lastSeenScan;
+        unsigned int idleScans;             // Consecutive reads with no CPU time used
+        std::string name;
+    };
+
+    std::unordered_map<unsigned long, ProcessState> processes;
+    std::vector<ProcessUsage> topByCpu;
+    std::vector<ProcessUsage> topByMemory;
+    std::vector<char> scanBuffer;
+    size_t topCount;
+    unsigned int scanNumber;
+    unsigned int cpuCount;
+
+public:
+    ProcessMonitor(size_t topN = 5);
+
+    bool sample();
+    const std::vector<ProcessUsage>& getTopByCpu() const;
+    const std::vector<ProcessUsage>& getTopByMemory() const;
+    size_t getProcessCount() const;
+    std::string getReport() const;
+    void setTopCount(size_t topN);
+    void clear();
+
+private:
+    bool scanProcesses(unsigned long long now);
+    ProcessState& trackProcess(unsigned long pid, unsigned long long startTime,
+                               unsigned long long cpuTime, unsigned long long rssBytes,
+                               unsigned long long now, bool& isNew);
+    void removeExitedProcesses();
+    void rankProcesses();
+    static unsigned long long getWallTime();
+    static unsigned int getCpuCount();
+};
+
+#endif // PROCESS_MONITOR_H
@@ -0,0 +1,43 @@
+#include "reply_framing.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const char ACK_PREFIX[] = "Server received (";
+const char ACK_SEPARATOR[] = " bytes): ";
+
+} // namespace
+
+bool takeLine(std::string& buffer, std::string& line) {
+    size_t end = buffer.find('\n');
+    if (end == std::string::npos) {
+        return false;
+    }
+    size_t length = end > 0 && buffer[end - 1] == '\r' ? end - 1 : end;
+    line.assign(buffer, 0, length);
+    buffer.erase(0, end + 1);
+    return true;
+}
+
+bool parseAck(const std::string& line, size_t& bytes, std::string* text) {
+    size_t prefixLength = sizeof(ACK_PREFIX) - 1;
+    if (line.compare(0, prefixLength, ACK_PREFIX) != 0) {
+        return false;
+    }
+    char* end;
+    bytes = strtoul(line.c_str() + prefixLength, &end, 10);
+    if (text != NULL) {
+        size_t separatorLength = sizeof(ACK_SEPARATOR) - 1;
+        size_t textStart = end - line.c_str();
+        if (line.compare(textStart, separatorLength, ACK_SEPARATOR) == 0) {
+            textStart += separatorLength;
+        }
+        text->assign(line, textStart, std::string::npos);
+    }
+    return true;
+}
+
+bool isPushedCommand(const std::string& line) {
+    return line.compare(0, 6, "QUERY:") == 0 || line.compare(0, 7, "UPDATE:") == 0;
+}
@@ -0,0 +1,20 @@
+#ifndef REPLY_FRAMING_H
+#define REPLY_FRAMING_H
+
+#include <cstddef>
+#include <string>
+
+// Everything a collector sends is a newline-terminated line. Each read it
+// makes of a bot message is acknowledged as
+//   Server received (<n> bytes): <text>
+// and pushed commands (QUERY:, UPDATE:) arrive as lines of their own.
+
+// Removes the first complete line from buffer, without its line ending
+bool takeLine(std::string& buffer, std::string& line);
+
+// Parses an acknowledgement; text, if given, receives the echoed message text
+bool parseAck(const std::string& line, size_t& bytes, std::string* text = NULL);
+
+bool isPushedCommand(const std::string& line);
+
+#endif // REPLY_FRAMING_H
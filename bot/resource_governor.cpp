@@ -0,0 +1,200 @@
+#include "resource_governor.h"
+#include <iostream>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <cstdio>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const double WINDOW_SECONDS = 10.0;     // Measurement window
+const int CALM_WINDOWS_TO_RECOVER = 6;  // One minute under budget per step back
+const double RECOVERY_MARGIN = 0.7;     // "Calm" means under 70% of every budget
+const int MAX_LEVEL = 3;
+
+} // namespace
+
+ResourceGovernor::ResourceGovernor(const ResourceBudget& budget)
+    : budget(budget), level(0), calmWindows(0), windowStart(0.0), windowCpuTime(0),
+      windowBytesSent(0), cpuPercent(0.0), rssBytes(0), bytesPerSecond(0.0) {
+}
+
+void ResourceGovernor::setBudget(const ResourceBudget& newBudget) {
+    budget = newBudget;
+}
+
+const ResourceBudget& ResourceGovernor::getBudget() const {
+    return budget;
+}
+
+bool ResourceGovernor::applyLowPriority() {
+#ifdef _WIN32
+    // Background mode lowers CPU, I/O and memory priority together
+    if (SetPriorityClass(GetCurrentProcess(), PROCESS_MODE_BACKGROUND_BEGIN)) {
+        return true;
+    }
+    return SetPriorityClass(GetCurrentProcess(), IDLE_PRIORITY_CLASS) != 0;
+#else
+    bool lowered = setpriority(PRIO_PROCESS, 0, 19) == 0;
+#ifdef SYS_ioprio_set
+    // IOPRIO_WHO_PROCESS = 1, IOPRIO_CLASS_IDLE = 3 shifted into the class bits
+    lowered = syscall(SYS_ioprio_set, 1, 0, 3 << 13) == 0 && lowered;
+#endif
+    return lowered;
+#endif
+}
+
+bool ResourceGovernor::update(unsigned long long totalBytesSent) {
+    unsigned long long cpuTime, resident;
+    if (!getOwnUsage(cpuTime, resident)) {
+        return false;
+    }
+    rssBytes = resident;
+
+    double current = now();
+    if (windowStart == 0.0) {
+        windowStart = current;
+        windowCpuTime = cpuTime;
+        windowBytesSent = totalBytesSent;
+        return false;
+    }
+
+    double elapsed = current - windowStart;
+    if (elapsed < WINDOW_SECONDS) {
+        return false;
+    }
+
+    cpuPercent = (double)(cpuTime - windowCpuTime) / (elapsed * 1e9) * 100.0;
+    bytesPerSecond = (double)(totalBytesSent - windowBytesSent) / elapsed;
+    windowStart = current;
+    windowCpuTime = cpuTime;
+    windowBytesSent = totalBytesSent;
+
+    bool overCpu = cpuPercent > budget.cpuPercent;
+    bool overMemory = rssBytes > budget.rssBytes;
+    bool overBandwidth = bytesPerSecond > budget.bytesPerSecond;
+    int previousLevel = level;
+
+    if (overCpu || overMemory || overBandwidth) {
+        calmWindows = 0;
+        if (level < MAX_LEVEL) {
+            level++;
+        }
+        if (overMemory) {
+            trimMemory();
+        }
+    } else if (cpuPercent < budget.cpuPercent * RECOVERY_MARGIN &&
+               rssBytes < budget.rssBytes * RECOVERY_MARGIN &&
+               bytesPerSecond < budget.bytesPerSecond * RECOVERY_MARGIN) {
+        if (level > 0 && ++calmWindows >= CALM_WINDOWS_TO_RECOVER) {
+            level--;
+            calmWindows = 0;
+        }
+    } else {
+        calmWindows = 0;
+    }
+
+    if (level != previousLevel) {
+        std::cout << "Resource governor: level " << previousLevel << " -> " << level
+                  << " (CPU " << cpuPercent << "%, RSS " << (rssBytes / (1024 * 1024)) << " MB, "
+                  << (long long)bytesPerSecond << " B/s)" << std::endl;
+    }
+    return level != previousLevel;
+}
+
+int ResourceGovernor::getLevel() const {
+    return level;
+}
+
+int ResourceGovernor::getSampleInterval(int baseInterval) const {
+    switch (level) {
+    case 0:  return baseInterval;
+    case 1:
+    case 2:  return baseInterval * 5;
+    default: return baseInterval * 15;
+    }
+}
+
+bool ResourceGovernor::allowProcessCollector() const {
+    return level < 2;
+}
+
+bool ResourceGovernor::allowDetailedReports() const {
+    return level < 3;
+}
+
+double ResourceGovernor::getCpuPercent() const {
+    return cpuPercent;
+}
+
+unsigned long long ResourceGovernor::getRssBytes() const {
+    return rssBytes;
+}
+
+double ResourceGovernor::getBytesPerSecond() const {
+    return bytesPerSecond;
+}
+
+#ifdef _WIN32
+
+bool ResourceGovernor::getOwnUsage(unsigned long long& cpuTimeNs, unsigned long long& residentBytes) {
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) {
+        return false;
+    }
+    cpuTimeNs = ((((unsigned long long)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime) +
+                 (((unsigned long long)user.dwHighDateTime << 32) | user.dwLowDateTime)) * 100;
+
+    PROCESS_MEMORY_COUNTERS memory;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &memory, sizeof(memory))) {
+        return false;
+    }
+    residentBytes = memory.WorkingSetSize;
+    return true;
+}
+
+void ResourceGovernor::trimMemory() {
+    // Hand unused working-set pages back to the OS
+    SetProcessWorkingSetSize(GetCurrentProcess(), (SIZE_T)-1, (SIZE_T)-1);
+}
+
+#else
+
+bool ResourceGovernor::getOwnUsage(unsigned long long& cpuTimeNs, unsigned long long& residentBytes) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return false;
+    }
+    cpuTimeNs = ((unsigned long long)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL +
+                 usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ULL;
+
+    // ru_maxrss is a peak; statm has the current resident page count
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == NULL) {
+        return false;
+    }
+    unsigned long long sizePages = 0, residentPages = 0;
+    bool parsed = fscanf(statm, "%llu %llu", &sizePages, &residentPages) == 2;
+    fclose(statm);
+
+    residentBytes = residentPages * (unsigned long long)sysconf(_SC_PAGESIZE);
+    return parsed;
+}
+
+void ResourceGovernor::trimMemory() {
+}
+
+#endif
+
+double ResourceGovernor::now() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,55 @@
+#ifndef RESOURCE_GOVERNOR_H
+#define RESOURCE_GOVERNOR_H
+
+struct ResourceBudget {
+    double cpuPercent;              // Percent of one core
+    unsigned long long rssBytes;
+    double bytesPerSecond;          // Outbound, all collectors together
+
+    ResourceBudget()
+        : cpuPercent(0.5), rssBytes(20ULL * 1024 * 1024), bytesPerSecond(4096.0) {
+    }
+};
+
+// Watches what the bot itself costs and degrades in steps when a budget is
+// exceeded:
+//   1 - sample metrics less often
+//   2 - also drop the per-process collector
+//   3 - also send compact status updates only
+// Levels rise one step per over-budget window and fall one step after
+// several calm windows, so the bot does not oscillate.
+class ResourceGovernor {
+private:
+    ResourceBudget budget;
+    int level;
+    int calmWindows;
+    double windowStart;
+    unsigned long long windowCpuTime;
+    unsigned long long windowBytesSent;
+    double cpuPercent;
+    unsigned long long rssBytes;
+    double bytesPerSecond;
+
+public:
+    ResourceGovernor(const ResourceBudget& budget = ResourceBudget());
+
+    void setBudget(const ResourceBudget& budget);
+    const ResourceBudget& getBudget() const;
+    bool applyLowPriority();
+    bool update(unsigned long long totalBytesSent);
+
+    int getLevel() const;
+    int getSampleInterval(int baseInterval) const;
+    bool allowProcessCollector() const;
+    bool allowDetailedReports() const;
+    double getCpuPercent() const;
+    unsigned long long getRssBytes() const;
+    double getBytesPerSecond() const;
+
+private:
+    static bool getOwnUsage(unsigned long long& cpuTimeNs, unsigned long long& residentBytes);
+    static void trimMemory();
+    static double now();
+};
+
+#endif // RESOURCE_GOVERNOR_H
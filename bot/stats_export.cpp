@@ -0,0 +1,203 @@
+#include "stats_export.h"
+#include <iostream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    uint32_t currentProcessId() {
+#ifdef _WIN32
+        return (uint32_t)GetCurrentProcessId();
+#else
+        return (uint32_t)getpid();
+#endif
+    }
+
+    bool isProcessAlive(uint32_t processId) {
+#ifdef _WIN32
+        HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, processId);
+        if (process == NULL) {
+            return GetLastError() == ERROR_ACCESS_DENIED;
+        }
+        bool alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+        CloseHandle(process);
+        return alive;
+#else
+        return kill((pid_t)processId, 0) == 0 || errno == EPERM;
+#endif
+    }
+
+    // An existing block belongs to another bot unless it names an owner that
+    // has exited. A block whose header is still being written counts as owned.
+    bool isOwnedByLiveBot(const BotStatsBlock* existing, uint32_t& owner) {
+        BotStats stats;
+        if (!readBotStats(existing, stats)) {
+            owner = 0;
+            return true;
+        }
+        owner = stats.processId;
+        return owner != currentProcessId() && isProcessAlive(owner);
+    }
+
+    void reportInUse(uint32_t owner) {
+        std::cerr << "ERROR: Stats shared memory is already in use by another bot";
+        if (owner != 0) {
+            std::cerr << " (pid " << owner << ")";
+        }
+        std::cerr << std::endl;
+    }
+}
+
+#ifdef _WIN32
+
+StatsExport::StatsExport() : block(NULL), mappingHandle(NULL) {
+}
+
+bool StatsExport::open() {
+    close();
+
+    mappingHandle = CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                      0, sizeof(BotStatsBlock), BOT_STATS_SHM_NAME);
+    if (mappingHandle == NULL) {
+        std::cerr << "ERROR: Failed to create stats shared memory" << std::endl;
+        return false;
+    }
+    // The name is per session, so a second bot would otherwise attach to the
+    // first one's block and both would write under the same seqlock
+    bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+
+    block = (BotStatsBlock*)MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(BotStatsBlock));
+    if (block == NULL) {
+        std::cerr << "ERROR: Failed to map stats shared memory" << std::endl;
+        close();
+        return false;
+    }
+
+    // A reader can keep an exited bot's block alive; that one may be reused
+    uint32_t owner;
+    if (existed && isOwnedByLiveBot(block, owner)) {
+        reportInUse(owner);
+        close();
+        return false;
+    }
+#else
+
+StatsExport::StatsExport() : block(NULL), sharedMemoryFd(-1) {
+}
+
+bool StatsExport::open() {
+    close();
+
+    // Create exclusively so a second bot never writes into the first one's
+    // block. A segment left behind by a bot that crashed is removed and recreated.
+    for (int attempt = 0; attempt < 2 && sharedMemoryFd < 0; attempt++) {
+        sharedMemoryFd = shm_open(BOT_STATS_SHM_NAME, O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (sharedMemoryFd >= 0 || errno != EEXIST) break;
+        if (!removeStaleSegment()) return false;
+    }
+    if (sharedMemoryFd < 0 || ftruncate(sharedMemoryFd, sizeof(BotStatsBlock)) != 0) {
+        std::cerr << "ERROR: Failed to create stats shared memory" << std::endl;
+        close();
+        return false;
+    }
+
+    void* mapping = mmap(NULL, sizeof(BotStatsBlock), PROT_READ | PROT_WRITE, MAP_SHARED, sharedMemoryFd, 0);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "ERROR: Failed to map stats shared memory" << std::endl;
+        close();
+        return false;
+    }
+    block = (BotStatsBlock*)mapping;
+#endif
+
+    // Readers ignore the block until the header is complete
+    block->magic = 0;
+    block->sequence.store(0, std::memory_order_relaxed);
+    memset(&block->stats, 0, sizeof(block->stats));
+    block->version = BOT_STATS_VERSION;
+    block->size = sizeof(BotStatsBlock);
+    block->stats.processId = currentProcessId();
+    std::atomic_thread_fence(std::memory_order_release);
+    block->magic = BOT_STATS_MAGIC;
+    return true;
+}
+
+void StatsExport::close() {
+#ifdef _WIN32
+    if (block != NULL) {
+        UnmapViewOfFile(block);
+        block = NULL;
+    }
+    if (mappingHandle != NULL) {
+        CloseHandle(mappingHandle);
+        mappingHandle = NULL;
+    }
+#else
+    if (block != NULL) {
+        munmap(block, sizeof(BotStatsBlock));
+        block = NULL;
+    }
+    if (sharedMemoryFd >= 0) {
+        ::close(sharedMemoryFd);
+        sharedMemoryFd = -1;
+        shm_unlink(BOT_STATS_SHM_NAME);
+    }
+#endif
+}
+
+#ifndef _WIN32
+bool StatsExport::removeStaleSegment() {
+    int fd = shm_open(BOT_STATS_SHM_NAME, O_RDONLY, 0);
+    if (fd < 0) {
+        // Removed by its owner in the meantime
+        return errno == ENOENT;
+    }
+
+    // The owner may not have sized the segment yet; mapping it would fault
+    uint32_t owner = 0;
+    bool owned = true;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(BotStatsBlock)) {
+        void* view = mmap(NULL, sizeof(BotStatsBlock), PROT_READ, MAP_SHARED, fd, 0);
+        if (view != MAP_FAILED) {
+            owned = isOwnedByLiveBot((const BotStatsBlock*)view, owner);
+            munmap(view, sizeof(BotStatsBlock));
+        }
+    }
+    ::close(fd);
+
+    if (owned) {
+        reportInUse(owner);
+        return false;
+    }
+    shm_unlink(BOT_STATS_SHM_NAME);
+    return true;
+}
+#endif
+
+StatsExport::~StatsExport() {
+    close();
+}
+
+bool StatsExport::isOpen() const {
+    return block != NULL;
+}
+
+void StatsExport::publish(const BotStats& stats) {
+    if (block == NULL) return;
+
+    // Seqlock write: odd sequence while the payload is being replaced
+    uint32_t sequence = block->sequence.load(std::memory_order_relaxed);
+    block->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy((void*)&block->stats, &stats, sizeof(stats));
+
+    block->sequence.store(sequence + 2, std::memory_order_release);
+}
@@ -0,0 +1,106 @@
+#ifndef STATS_EXPORT_H
+#define STATS_EXPORT_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#define BOT_STATS_SHM_NAME "Local\\RemoteActivityBotStats"
+#else
+#define BOT_STATS_SHM_NAME "/remote_activity_bot_stats"
+#endif
+
+const uint32_t BOT_STATS_MAGIC = 0x53544142;   // "BATS"
+const uint32_t BOT_STATS_VERSION = 2;
+
+// Payload of the shared stats block. Fields are only ever appended; readers
+// check version and size before trusting the layout.
+struct BotStats {
+    uint32_t processId;
+    uint32_t connected;
+    char serverAddress[64];
+    uint32_t serverPort;
+    uint32_t queueDepth;
+    int64_t startTime;              // Unix seconds
+    int64_t lastReportTime;         // Unix seconds, 0 before the first report
+    uint64_t reportsSent;
+    uint64_t messagesSent;
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+    uint64_t sendErrors;
+    uint64_t receiveErrors;
+    uint64_t receiveTimeouts;
+    uint64_t reconnects;
+    double smoothedRttMs;
+    double bandwidthBytesPerSecond;
+    double cpuPercent;
+    double availableMemoryMb;
+    // Version 2
+    double agentCpuPercent;         // The bot's own CPU use, percent of one core
+    uint64_t agentRssBytes;
+    uint32_t governorLevel;
+};
+
+// Fixed-layout block placed at the start of the shared-memory segment and
+// updated under a seqlock: the sequence is odd while the bot is writing.
+struct BotStatsBlock {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    std::atomic<uint32_t> sequence;
+    BotStats stats;
+};
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "seqlock needs a lock-free counter");
+
+// Copies a consistent snapshot out of a mapped block without any syscalls.
+// Returns false if the layout is unknown or the writer kept it busy.
+inline bool readBotStats(const BotStatsBlock* block, BotStats& out, int maxAttempts = 1000) {
+    if (block->magic != BOT_STATS_MAGIC || block->version < BOT_STATS_VERSION ||
+        block->size < sizeof(BotStatsBlock)) {
+        return false;
+    }
+
+    for (int attempt = 0; attempt < maxAttempts; attempt++) {
+        uint32_t before = block->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        memcpy(&out, (const void*)&block->stats, sizeof(out));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (block->sequence.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+    return false;
+}
+
+class StatsExport {
+private:
+    BotStatsBlock* block;
+#ifdef _WIN32
+    HANDLE mappingHandle;
+#else
+    int sharedMemoryFd;
+#endif
+
+public:
+    StatsExport();
+    ~StatsExport();
+
+    bool open();
+    void close();
+    bool isOpen() const;
+    void publish(const BotStats& stats);
+
+private:
+#ifndef _WIN32
+    bool removeStaleSegment();
+#endif
+    StatsExport(const StatsExport&);
+    StatsExport& operator=(const StatsExport&);
+};
+
+#endif // STATS_EXPORT_H
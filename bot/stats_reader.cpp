@@ -0,0 +1,67 @@
+#include "stats_export.h"
+#include <iostream>
+#include <ctime>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Prints the bot's shared-memory stats. Pass -w to keep printing every second.
+int main(int argc, char* argv[]) {
+    bool watch = argc > 1 && strcmp(argv[1], "-w") == 0;
+
+#ifdef _WIN32
+    HANDLE mapping = OpenFileMapping(FILE_MAP_READ, FALSE, BOT_STATS_SHM_NAME);
+    const BotStatsBlock* block = mapping != NULL ?
+        (const BotStatsBlock*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(BotStatsBlock)) : NULL;
+#else
+    int fd = shm_open(BOT_STATS_SHM_NAME, O_RDONLY, 0);
+    void* view = fd >= 0 ? mmap(NULL, sizeof(BotStatsBlock), PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    const BotStatsBlock* block = view != MAP_FAILED ? (const BotStatsBlock*)view : NULL;
+#endif
+
+    if (block == NULL) {
+        std::cerr << "ERROR: Bot stats not found - is the bot running?" << std::endl;
+        return 1;
+    }
+
+    do {
+        BotStats stats;
+        if (!readBotStats(block, stats)) {
+            std::cerr << "ERROR: Could not read a consistent stats snapshot" << std::endl;
+            return 1;
+        }
+
+        long long now = (long long)time(NULL);
+        std::cout << "=== BOT STATS (pid " << stats.processId << ") ===" << std::endl;
+        std::cout << "Server: " << stats.serverAddress << ":" << stats.serverPort
+                  << (stats.connected ? " (connected)" : " (disconnected)") << std::endl;
+        std::cout << "Uptime: " << (now - stats.startTime) << " s" << std::endl;
+        if (stats.lastReportTime != 0) {
+            std::cout << "Last report: " << (now - stats.lastReportTime) << " s ago" << std::endl;
+        }
+        std::cout << "Reports sent: " << stats.reportsSent << " | Queue depth: " << stats.queueDepth << std::endl;
+        std::cout << "Messages sent: " << stats.messagesSent << " | Bytes sent/received: "
+                  << stats.bytesSent << "/" << stats.bytesReceived << std::endl;
+        std::cout << "Errors: send " << stats.sendErrors << ", receive " << stats.receiveErrors
+                  << ", timeouts " << stats.receiveTimeouts << ", reconnects " << stats.reconnects << std::endl;
+        std::cout << "RTT: " << stats.smoothedRttMs << " ms | Bandwidth: "
+                  << (long long)stats.bandwidthBytesPerSecond << " B/s" << std::endl;
+        std::cout << "CPU: " << stats.cpuPercent << "% | Available RAM: " << stats.availableMemoryMb << " MB" << std::endl;
+        std::cout << "Bot overhead: CPU " << stats.agentCpuPercent << "% | RSS "
+                  << (stats.agentRssBytes / 1024) << " KB | Governor level " << stats.governorLevel << std::endl;
+
+        if (watch) {
+#ifdef _WIN32
+            Sleep(1000);
+#else
+            sleep(1);
+#endif
+        }
+    } while (watch);
+
+    return 0;
+}
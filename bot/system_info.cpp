@@ -257,6 +257,31 @@ std::string SystemInfo::getMemoryInfo() {
     return ss.str();
 }
 
+bool SystemInfo::getCpuTimes(unsigned long long& idleTime, unsigned long long& totalTime) {
+    FILETIME idle, kernel, user;
+    if (!GetSystemTimes(&idle, &kernel, &user)) {
+        return false;
+    }
+
+    // Kernel time already includes idle time
+    idleTime = ((unsigned long long)idle.dwHighDateTime << 32) | idle.dwLowDateTime;
+    totalTime = (((unsigned long long)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime) +
+                (((unsigned long long)user.dwHighDateTime << 32) | user.dwLowDateTime);
+    return true;
+}
+
+bool SystemInfo::getMemoryStatus(unsigned long long& availableBytes, unsigned long& loadPercent) {
+    MEMORYSTATUSEX memInfo;
+    memInfo.dwLength = sizeof(MEMORYSTATUSEX);
+    if (!GlobalMemoryStatusEx(&memInfo)) {
+        return false;
+    }
+
+    availableBytes = memInfo.ullAvailPhys;
+    loadPercent = memInfo.dwMemoryLoad;
+    return true;
+}
+
 std::string SystemInfo::getTimeInfo() {
     std::stringstream ss;
     
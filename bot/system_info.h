@@ -11,6 +11,8 @@ public:
     static std::string getUpdateUrl();
     static bool checkForUpdates();
     static bool downloadAndUpdate(const std::string& updateUrl);
+    static bool getCpuTimes(unsigned long long& idleTime, unsigned long long& totalTime);
+    static bool getMemoryStatus(unsigned long long& availableBytes, unsigned long& loadPercent);
     
 private:
     static const std::string VERSION;
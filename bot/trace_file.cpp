@@ -0,0 +1,149 @@
+#include "trace_file.h"
+#include <iostream>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+const char TRACE_MAGIC[8] = { 'R', 'A', 'T', 'R', 'A', 'C', 'E', '1' };
+const unsigned long long MAX_RECORD_BYTES = 64ULL * 1024 * 1024;   // Guards against corrupt lengths
+
+} // namespace
+
+TraceWriter::TraceWriter() : file(NULL), startTime(0), lastTime(0), recordCount(0) {
+}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+bool TraceWriter::open(const std::string& path) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (file == NULL) {
+        std::cerr << "ERROR: Could not create trace file " << path << std::endl;
+        return false;
+    }
+    fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), file);
+    startTime = nowUs();
+    lastTime = startTime;
+    recordCount = 0;
+    return true;
+}
+
+void TraceWriter::close() {
+    if (file != NULL) {
+        fclose(file);
+        file = NULL;
+    }
+}
+
+bool TraceWriter::isOpen() const {
+    return file != NULL;
+}
+
+void TraceWriter::record(TraceRecordType type, const char* data, size_t length) {
+    if (file == NULL) return;
+
+    unsigned long long now = nowUs();
+    fputc((int)type, file);
+    writeVarint(now - lastTime);
+    writeVarint(length);
+    if (length > 0) {
+        fwrite(data, 1, length, file);
+    }
+    lastTime = now;
+    recordCount++;
+
+    // The bot is usually stopped by killing it; keep the trace readable up to here
+    fflush(file);
+}
+
+unsigned long long TraceWriter::getRecordCount() const {
+    return recordCount;
+}
+
+void TraceWriter::writeVarint(unsigned long long value) {
+    unsigned char bytes[10];
+    size_t count = 0;
+    do {
+        bytes[count] = (unsigned char)(value & 0x7F);
+        value >>= 7;
+        if (value != 0) bytes[count] |= 0x80;
+        count++;
+    } while (value != 0);
+    fwrite(bytes, 1, count, file);
+}
+
+unsigned long long TraceWriter::nowUs() {
+    using namespace std::chrono;
+    return (unsigned long long)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+TraceReader::TraceReader() : file(NULL), timestampUs(0) {
+}
+
+TraceReader::~TraceReader() {
+    close();
+}
+
+bool TraceReader::open(const std::string& path) {
+    close();
+    file = fopen(path.c_str(), "rb");
+    if (file == NULL) {
+        std::cerr << "ERROR: Could not open trace file " << path << std::endl;
+        return false;
+    }
+
+    char magic[sizeof(TRACE_MAGIC)];
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+        memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0) {
+        std::cerr << "ERROR: " << path << " is not a trace file" << std::endl;
+        close();
+        return false;
+    }
+    timestampUs = 0;
+    return true;
+}
+
+void TraceReader::close() {
+    if (file != NULL) {
+        fclose(file);
+        file = NULL;
+    }
+}
+
+bool TraceReader::next(TraceRecord& record) {
+    if (file == NULL) return false;
+
+    int type = fgetc(file);
+    if (type == EOF) return false;
+
+    unsigned long long delta, length;
+    if (type > TRACE_CONNECTED || !readVarint(delta) || !readVarint(length) || length > MAX_RECORD_BYTES) {
+        std::cerr << "WARNING: Trace is truncated or corrupt; stopping early" << std::endl;
+        return false;
+    }
+
+    record.data.resize((size_t)length);
+    if (length > 0 && fread(&record.data[0], 1, (size_t)length, file) != length) {
+        std::cerr << "WARNING: Trace is truncated or corrupt; stopping early" << std::endl;
+        return false;
+    }
+
+    timestampUs += delta;
+    record.type = (TraceRecordType)type;
+    record.timestampUs = timestampUs;
+    return true;
+}
+
+bool TraceReader::readVarint(unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = fgetc(file);
+        if (byte == EOF) return false;
+        value |= (unsigned long long)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
@@ -0,0 +1,61 @@
+#ifndef TRACE_FILE_H
+#define TRACE_FILE_H
+
+#include <cstdio>
+#include <string>
+
+// Wire-traffic trace: an 8-byte "RATRACE1" header followed by records of
+//   [u8 type][varint microseconds since previous record][varint length][bytes]
+// Varints are LEB128, so a typical record costs 3-5 bytes of framing.
+enum TraceRecordType {
+    TRACE_SENT = 0,         // Bytes the bot sent to the collector
+    TRACE_RECEIVED = 1,     // Bytes the bot read back
+    TRACE_CONNECTED = 2     // A new connection was opened; no payload
+};
+
+struct TraceRecord {
+    TraceRecordType type;
+    unsigned long long timestampUs;     // Since the start of the capture
+    std::string data;
+};
+
+class TraceWriter {
+private:
+    FILE* file;
+    unsigned long long startTime;
+    unsigned long long lastTime;
+    unsigned long long recordCount;
+
+public:
+    TraceWriter();
+    ~TraceWriter();
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+    void record(TraceRecordType type, const char* data, size_t length);
+    unsigned long long getRecordCount() const;
+
+private:
+    void writeVarint(unsigned long long value);
+    static unsigned long long nowUs();
+};
+
+class TraceReader {
+private:
+    FILE* file;
+    unsigned long long timestampUs;
+
+public:
+    TraceReader();
+    ~TraceReader();
+
+    bool open(const std::string& path);
+    void close();
+    bool next(TraceRecord& record);
+
+private:
+    bool readVarint(unsigned long long& value);
+};
+
+#endif // TRACE_FILE_H
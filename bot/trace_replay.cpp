@@ -0,0 +1,424 @@
+#include "trace_file.h"
+#include "reply_framing.h"
+#include <winsock2.h>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+// Plays captured bot traffic (see --capture) against a collector.
+//
+//   trace_replay <ip> <port> [--speed <N>|max] [--clients <N>] [--no-verify] <trace>...
+//
+// Every trace is replayed by --clients connections in parallel. Sends keep the
+// recorded spacing divided by --speed; "max" sends as soon as the previous
+// reply is in. Replies are compared with the recorded ones, and the exit code
+// is non-zero if any differed, so a replay doubles as an ingest regression
+// test. Acknowledgements are compared by total bytes and echoed text rather
+// than per read, since the collector splits messages into reads differently
+// on every run; other lines such as PONG must match exactly.
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const DWORD REPLY_TIMEOUT_MS = 5000;
+const size_t MAX_REPORTED_MISMATCHES = 3;
+
+struct ReplayResult {
+    unsigned long long messagesSent;
+    unsigned long long bytesSent;
+    unsigned long long bytesReceived;
+    unsigned long long replies;
+    unsigned long long mismatches;
+    unsigned long long timeouts;
+    unsigned long long connections;
+    unsigned long long connectFailures;
+    std::vector<double> latenciesMs;
+};
+
+struct ReplayOptions {
+    sockaddr_in server;
+    double speed;           // 0 = as fast as replies allow
+    bool verify;
+};
+
+bool loadTrace(const std::string& path, std::vector<TraceRecord>& records) {
+    TraceReader reader;
+    if (!reader.open(path)) {
+        return false;
+    }
+    TraceRecord record;
+    while (reader.next(record)) {
+        records.push_back(record);
+    }
+    return true;
+}
+
+// A trace turned into what the replay does and expects, in order
+enum ReplayStepType {
+    STEP_CONNECT,       // Open a new connection
+    STEP_SEND,          // Send data
+    STEP_ACK,           // Wait for acknowledgements covering ackBytes; data is their joined text
+    STEP_LINE           // Wait for one other reply line (PONG) and match it exactly
+};
+
+struct ReplayStep {
+    ReplayStepType type;
+    unsigned long long timestampUs;
+    std::string data;
+    size_t ackBytes;
+};
+
+// Acknowledgements echo one collector read each, and how a message is split
+// into reads differs from run to run, so consecutive acknowledgements become
+// one step that expects their total byte count and joined text. Pushed
+// commands (UPDATE, QUERY) came from the operator, not from anything the bot
+// sent, so they are dropped. Returns the number of lines dropped.
+size_t buildSteps(const std::vector<TraceRecord>& records, std::vector<ReplayStep>& steps) {
+    std::string partial;        // Received bytes not yet split into lines
+    size_t stripped = 0;
+
+    for (const TraceRecord& record : records) {
+        if (record.type != TRACE_RECEIVED) {
+            if (record.type == TRACE_CONNECTED) {
+                partial.clear();
+            }
+            ReplayStep step;
+            step.type = record.type == TRACE_SENT ? STEP_SEND : STEP_CONNECT;
+            step.timestampUs = record.timestampUs;
+            step.data = record.data;
+            step.ackBytes = 0;
+            steps.push_back(step);
+            continue;
+        }
+
+        partial += record.data;
+        std::string line;
+        while (takeLine(partial, line)) {
+            size_t acknowledged;
+            std::string text;
+            if (isPushedCommand(line)) {
+                stripped++;
+            } else if (parseAck(line, acknowledged, &text)) {
+                if (steps.empty() || steps.back().type != STEP_ACK) {
+                    ReplayStep step;
+                    step.type = STEP_ACK;
+                    step.timestampUs = record.timestampUs;
+                    step.ackBytes = 0;
+                    steps.push_back(step);
+                }
+                steps.back().ackBytes += acknowledged;
+                steps.back().data += text;
+            } else if (!line.empty()) {
+                ReplayStep step;
+                step.type = STEP_LINE;
+                step.timestampUs = record.timestampUs;
+                step.data = line;
+                step.ackBytes = 0;
+                steps.push_back(step);
+            }
+        }
+    }
+    return stripped;
+}
+
+// Replies read on the live connection but not yet matched. Acknowledgements
+// are pooled, so a step may be covered by more or fewer reads than recorded.
+struct LiveReplies {
+    std::string buffer;
+    size_t ackedBytes;
+    std::string ackedText;
+    std::deque<std::string> lines;
+
+    LiveReplies() : ackedBytes(0) {
+    }
+};
+
+SOCKET openConnection(const ReplayOptions& options) {
+    SOCKET sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock == INVALID_SOCKET) {
+        return INVALID_SOCKET;
+    }
+    if (connect(sock, (const sockaddr*)&options.server, sizeof(options.server)) == SOCKET_ERROR) {
+        closesocket(sock);
+        return INVALID_SOCKET;
+    }
+    DWORD timeout = REPLY_TIMEOUT_MS;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+    return sock;
+}
+
+bool sendAll(SOCKET sock, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        int result = send(sock, data.c_str() + sent, (int)(data.size() - sent), 0);
+        if (result == SOCKET_ERROR) {
+            return false;
+        }
+        sent += result;
+    }
+    return true;
+}
+
+std::string printable(const std::string& data) {
+    std::string text = data.substr(0, 80);
+    for (char& c : text) {
+        if (c == '\n' || c == '\r') c = ' ';
+    }
+    return data.size() > 80 ? text + "..." : text;
+}
+
+// Reads once from the collector and sorts complete lines into live
+bool readReplies(SOCKET sock, LiveReplies& live, ReplayResult& result) {
+    char buffer[4096];
+    int len = recv(sock, buffer, sizeof(buffer), 0);
+    if (len <= 0) {
+        return false;
+    }
+    result.bytesReceived += len;
+    live.buffer.append(buffer, len);
+
+    std::string line;
+    while (takeLine(live.buffer, line)) {
+        size_t acknowledged;
+        std::string text;
+        if (parseAck(line, acknowledged, &text)) {
+            live.ackedBytes += acknowledged;
+            live.ackedText += text;
+        } else if (!line.empty() && !isPushedCommand(line)) {
+            live.lines.push_back(line);
+        }
+    }
+    return true;
+}
+
+void reportMismatch(const std::string& name, const std::string& expected, const std::string& got,
+                    ReplayResult& result) {
+    if (result.mismatches < MAX_REPORTED_MISMATCHES) {
+        std::cerr << "MISMATCH [" << name << "] expected \"" << printable(expected)
+                  << "\" got \"" << printable(got) << "\"" << std::endl;
+    }
+    result.mismatches++;
+}
+
+void replayTrace(const std::vector<ReplayStep>& steps, const ReplayOptions& options,
+                 Clock::time_point startTime, const std::string& name, ReplayResult& result) {
+    SOCKET sock = INVALID_SOCKET;
+    LiveReplies live;
+    Clock::time_point lastSend;
+    bool awaitingFirstReply = false;
+
+    // Clients start together so the collector sees the combined burst
+    std::this_thread::sleep_until(startTime);
+
+    for (const ReplayStep& step : steps) {
+        if (step.type == STEP_CONNECT || (sock == INVALID_SOCKET && step.type == STEP_SEND)) {
+            if (sock != INVALID_SOCKET) {
+                closesocket(sock);
+            }
+            live = LiveReplies();
+            sock = openConnection(options);
+            if (sock == INVALID_SOCKET) {
+                result.connectFailures++;
+                continue;
+            }
+            result.connections++;
+            if (step.type == STEP_CONNECT) {
+                continue;
+            }
+        }
+        if (sock == INVALID_SOCKET) {
+            continue;
+        }
+
+        if (step.type == STEP_SEND) {
+            if (options.speed > 0) {
+                long long offsetUs = (long long)(step.timestampUs / options.speed);
+                std::this_thread::sleep_until(startTime + std::chrono::microseconds(offsetUs));
+            }
+            if (!sendAll(sock, step.data)) {
+                closesocket(sock);
+                sock = INVALID_SOCKET;
+                continue;
+            }
+            lastSend = Clock::now();
+            awaitingFirstReply = true;
+            result.messagesSent++;
+            result.bytesSent += step.data.size();
+            continue;
+        }
+
+        // The bot waited for this reply, so the replay does too
+        bool received = true;
+        while (received && (step.type == STEP_ACK ? live.ackedBytes < step.ackBytes : live.lines.empty())) {
+            received = readReplies(sock, live, result);
+            if (received && awaitingFirstReply) {
+                result.latenciesMs.push_back(
+                    std::chrono::duration<double, std::milli>(Clock::now() - lastSend).count());
+                awaitingFirstReply = false;
+            }
+        }
+        if (!received) {
+            result.timeouts++;
+            closesocket(sock);
+            sock = INVALID_SOCKET;
+            continue;
+        }
+
+        result.replies++;
+        if (step.type == STEP_ACK) {
+            std::string got = live.ackedText.substr(0, step.data.size());
+            if (options.verify && got != step.data) {
+                reportMismatch(name, step.data, got, result);
+            }
+            live.ackedBytes -= step.ackBytes;
+            live.ackedText.erase(0, got.size());
+        } else {
+            if (options.verify && live.lines.front() != step.data) {
+                reportMismatch(name, step.data, live.lines.front(), result);
+            }
+            live.lines.pop_front();
+        }
+    }
+
+    if (sock != INVALID_SOCKET) {
+        closesocket(sock);
+    }
+}
+
+double percentile(std::vector<double>& values, double fraction) {
+    if (values.empty()) return 0.0;
+    size_t index = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void printUsage() {
+    std::cerr << "Usage: trace_replay <ip> <port> [--speed <N>|max] [--clients <N>] [--no-verify] <trace>..." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage();
+        return 1;
+    }
+
+    ReplayOptions options;
+    memset(&options.server, 0, sizeof(options.server));
+    options.server.sin_family = AF_INET;
+    options.server.sin_addr.s_addr = inet_addr(argv[1]);
+    options.server.sin_port = htons((unsigned short)atoi(argv[2]));
+    options.speed = 1.0;
+    options.verify = true;
+    int clientsPerTrace = 1;
+    std::vector<std::string> tracePaths;
+
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            i++;
+            options.speed = strcmp(argv[i], "max") == 0 ? 0.0 : atof(argv[i]);
+        } else if (strcmp(argv[i], "--clients") == 0 && i + 1 < argc) {
+            clientsPerTrace = std::max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--no-verify") == 0) {
+            options.verify = false;
+        } else {
+            tracePaths.push_back(argv[i]);
+        }
+    }
+    if (tracePaths.empty() || options.speed < 0) {
+        printUsage();
+        return 1;
+    }
+
+    // Load everything up front so disk reads don't distort the timing
+    std::vector<std::vector<ReplayStep>> traces(tracePaths.size());
+    for (size_t i = 0; i < tracePaths.size(); i++) {
+        std::vector<TraceRecord> records;
+        if (!loadTrace(tracePaths[i], records)) {
+            return 1;
+        }
+        size_t stripped = buildSteps(records, traces[i]);
+        std::cout << tracePaths[i] << ": " << records.size() << " records";
+        if (stripped > 0) {
+            std::cout << " (" << stripped << " pushed commands stripped)";
+        }
+        std::cout << std::endl;
+    }
+
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2,2), &wsaData) != 0) {
+        std::cerr << "ERROR: WSAStartup failed" << std::endl;
+        return 1;
+    }
+
+    size_t clientCount = tracePaths.size() * clientsPerTrace;
+    std::vector<ReplayResult> results(clientCount);
+    std::vector<std::thread> threads;
+    Clock::time_point startTime = Clock::now() + std::chrono::milliseconds(100);
+
+    for (size_t i = 0; i < clientCount; i++) {
+        size_t trace = i % tracePaths.size();
+        std::string name = tracePaths[trace] + "#" + std::to_string(i / tracePaths.size());
+        threads.emplace_back(replayTrace, std::cref(traces[trace]), std::cref(options),
+                             startTime, name, std::ref(results[i]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - startTime).count();
+    WSACleanup();
+
+    ReplayResult total = ReplayResult();
+    for (const ReplayResult& result : results) {
+        total.messagesSent += result.messagesSent;
+        total.bytesSent += result.bytesSent;
+        total.bytesReceived += result.bytesReceived;
+        total.replies += result.replies;
+        total.mismatches += result.mismatches;
+        total.timeouts += result.timeouts;
+        total.connections += result.connections;
+        total.connectFailures += result.connectFailures;
+        total.latenciesMs.insert(total.latenciesMs.end(), result.latenciesMs.begin(), result.latenciesMs.end());
+    }
+
+    double averageLatency = 0.0;
+    for (double latency : total.latenciesMs) {
+        averageLatency += latency;
+    }
+    if (!total.latenciesMs.empty()) {
+        averageLatency /= total.latenciesMs.size();
+    }
+
+    std::stringstream speed;
+    if (options.speed > 0) {
+        speed << options.speed << "x";
+    } else {
+        speed << "max speed";
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "=== REPLAY RESULTS (" << clientCount << " clients, " << speed.str() << ") ===" << std::endl;
+    std::cout << "Elapsed: " << elapsed << " s" << std::endl;
+    std::cout << "Messages sent: " << total.messagesSent << " (" << total.messagesSent / elapsed << "/s) | Bytes sent/received: "
+              << total.bytesSent << "/" << total.bytesReceived << std::endl;
+    std::cout << "Replies: " << total.replies << " | Mismatches: " << total.mismatches
+              << " | Timeouts: " << total.timeouts << std::endl;
+    std::cout << "Connections: " << total.connections << " | Failed: " << total.connectFailures << std::endl;
+    std::cout << "Reply latency ms: avg " << averageLatency
+              << ", p50 " << percentile(total.latenciesMs, 0.50)
+              << ", p99 " << percentile(total.latenciesMs, 0.99)
+              << ", max " << percentile(total.latenciesMs, 1.0) << std::endl;
+
+    bool failed = total.mismatches > 0 || total.timeouts > 0 || total.connectFailures > 0;
+    return failed ? 1 : 0;
+}
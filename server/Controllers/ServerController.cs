@@ -38,6 +38,7 @@ namespace server.Controllers
             _view.ClearLogRequested += OnClearLogRequested;
             _view.CopyLogRequested += OnCopyLogRequested;
             _view.UpdateAllRequested += OnUpdateAllRequested;
+            _view.QueryAllRequested += OnQueryAllRequested;
 
             // Initialize the view
             InitializeView();
@@ -151,14 +152,14 @@ namespace server.Controllers
         /// </summary>
         /// <param name="sender">Event sender</param>
         /// <param name="e">Event arguments</param>
-        private void OnUpdateAllRequested(object? sender, EventArgs e)
+        private async void OnUpdateAllRequested(object? sender, EventArgs e)
         {
             try
             {
                 // For now, we'll use a hardcoded update URL
                 // In a real implementation, this would be configurable
                 string updateUrl = "http://192.168.1.100:8080/updates/modular_bot.exe";
-                SendUpdateToAllClients(updateUrl);
+                await SendUpdateToAllClientsAsync(updateUrl);
             }
             catch (Exception ex)
             {
@@ -166,6 +167,36 @@ namespace server.Controllers
             }
         }
 
+        /// <summary>
+        /// Handles query all requests from the view
+        /// </summary>
+        /// <param name="sender">Event sender</param>
+        /// <param name="query">The query as metric:aggregate:windowSeconds[:threshold]</param>
+        private async void OnQueryAllRequested(object? sender, string query)
+        {
+            var parts = query.Split(':');
+            if (parts.Length < 3 || parts.Length > 4 ||
+                !int.TryParse(parts[2], out int windowSeconds) || windowSeconds <= 0)
+            {
+                _view.ShowMessage("Enter a query as metric:aggregate:windowSeconds[:threshold]", "Invalid Query");
+                return;
+            }
+
+            double? threshold = null;
+            if (parts.Length == 4)
+            {
+                if (!double.TryParse(parts[3], System.Globalization.NumberStyles.Float,
+                                     System.Globalization.CultureInfo.InvariantCulture, out double value))
+                {
+                    _view.ShowMessage("The threshold must be a number", "Invalid Query");
+                    return;
+                }
+                threshold = value;
+            }
+
+            await SendQueryToAllClientsAsync(parts[0], parts[1], windowSeconds, threshold);
+        }
+
         /// <summary>
         /// Handles server status changes from the model
         /// </summary>
@@ -222,11 +253,13 @@ namespace server.Controllers
         /// Sends an update command to all connected clients
         /// </summary>
         /// <param name="updateUrl">The URL where the new version can be downloaded</param>
-        public void SendUpdateToAllClients(string updateUrl)
+        /// <returns>Task representing the async operation</returns>
+        public async Task SendUpdateToAllClientsAsync(string updateUrl)
         {
             try
             {
-                _model.SendUpdateToAllClients(updateUrl);
+                // Socket writes stay off the UI thread so a slow client can't freeze it
+                await Task.Run(() => _model.SendUpdateToAllClientsAsync(updateUrl));
                 _view.ShowMessage($"Update command sent to {_model.ConnectedClientsCount} clients", "Success");
             }
             catch (Exception ex)
@@ -240,11 +273,12 @@ namespace server.Controllers
         /// </summary>
         /// <param name="client">The client to update</param>
         /// <param name="updateUrl">The URL where the new version can be downloaded</param>
-        public void SendUpdateToClient(System.Net.Sockets.TcpClient client, string updateUrl)
+        /// <returns>Task representing the async operation</returns>
+        public async Task SendUpdateToClientAsync(System.Net.Sockets.TcpClient client, string updateUrl)
         {
             try
             {
-                _model.SendUpdateToClient(client, updateUrl);
+                await Task.Run(() => _model.SendUpdateToClientAsync(client, updateUrl));
                 var clientAddress = ((System.Net.IPEndPoint)client.Client.RemoteEndPoint!).Address;
                 _view.ShowMessage($"Update command sent to client {clientAddress}", "Success");
             }
@@ -254,6 +288,26 @@ namespace server.Controllers
             }
         }
 
+        /// <summary>
+        /// Sends an aggregate query to all connected clients; results arrive in the log
+        /// </summary>
+        /// <param name="metric">The metric name, e.g. cpu_percent</param>
+        /// <param name="aggregate">avg, min, max, sum, count, above or a percentile such as p95</param>
+        /// <param name="windowSeconds">How far back from now the query covers</param>
+        /// <param name="threshold">Threshold for the "above" aggregate</param>
+        /// <returns>Task representing the async operation</returns>
+        public async Task SendQueryToAllClientsAsync(string metric, string aggregate, int windowSeconds, double? threshold = null)
+        {
+            try
+            {
+                await Task.Run(() => _model.SendQueryToAllClientsAsync(metric, aggregate, windowSeconds, threshold));
+            }
+            catch (Exception ex)
+            {
+                _view.ShowMessage($"Failed to send query: {ex.Message}", "Error");
+            }
+        }
+
         /// <summary>
         /// Disposes the controller and cleans up resources
         /// </summary>
@@ -269,6 +323,7 @@ namespace server.Controllers
             _view.ClearLogRequested -= OnClearLogRequested;
             _view.CopyLogRequested -= OnCopyLogRequested;
             _view.UpdateAllRequested -= OnUpdateAllRequested;
+            _view.QueryAllRequested -= OnQueryAllRequested;
 
             // Stop server if running
             if (_model.IsServerRunning)
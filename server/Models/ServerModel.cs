@@ -1,5 +1,6 @@
 using System;
 using System.Collections.Generic;
+using System.Linq;
 using System.Net;
 using System.Net.Sockets;
 using System.Threading.Tasks;
@@ -16,11 +17,13 @@ namespace server.Models
         private UdpClient? _discoveryClient;
         private volatile bool _isServerRunning = false;
         private readonly List<TcpClient> _connectedClients = new();
+        private readonly Dictionary<TcpClient, SemaphoreSlim> _clientWriteLocks = new();
         private readonly List<string> _logMessages = new();
         private readonly object _clientsLock = new();
         private readonly object _logLock = new();
         private const int MaxLogEntries = 5000;
         private CancellationTokenSource? _discoveryCancellationToken;
+        private int _nextQueryId = 0;
 
         /// <summary>
         /// Event raised when server status changes
@@ -81,55 +84,109 @@ namespace server.Models
         /// Sends an update command to all connected clients
         /// </summary>
         /// <param name="updateUrl">The URL where the new version can be downloaded</param>
-        public void SendUpdateToAllClients(string updateUrl)
+        /// <returns>Task that completes once every client has been written to</returns>
+        public async Task SendUpdateToAllClientsAsync(string updateUrl)
         {
-            var updateCommand = $"UPDATE:{updateUrl}";
+            var updateCommand = $"UPDATE:{updateUrl}\n";
             var updateBytes = System.Text.Encoding.ASCII.GetBytes(updateCommand);
-            
+
+            var sent = await WriteToAllClientsAsync(updateBytes).ConfigureAwait(false);
+            AddLogMessage($"Update command sent to {sent} clients");
+        }
+
+        /// <summary>
+        /// Sends an update command to a specific client
+        /// </summary>
+        /// <param name="client">The client to update</param>
+        /// <param name="updateUrl">The URL where the new version can be downloaded</param>
+        /// <returns>Task that completes once the client has been written to</returns>
+        public async Task SendUpdateToClientAsync(TcpClient client, string updateUrl)
+        {
+            var updateCommand = $"UPDATE:{updateUrl}\n";
+            var updateBytes = System.Text.Encoding.ASCII.GetBytes(updateCommand);
+
+            if (await WriteToClientAsync(client, updateBytes).ConfigureAwait(false))
+            {
+                var clientAddress = ((IPEndPoint)client.Client.RemoteEndPoint!).Address;
+                AddLogMessage($"Update command sent to specific client {clientAddress}");
+            }
+        }
+
+        /// <summary>
+        /// Sends an aggregate query to all connected clients. Each bot evaluates it
+        /// against its local history and answers with a single QUERY_RESULT line.
+        /// </summary>
+        /// <param name="metric">The metric name, e.g. cpu_percent</param>
+        /// <param name="aggregate">avg, min, max, sum, count, above or a percentile such as p95</param>
+        /// <param name="windowSeconds">How far back from now the query covers</param>
+        /// <param name="threshold">Threshold for the "above" aggregate</param>
+        /// <returns>The query id used to match results in the log</returns>
+        public async Task<int> SendQueryToAllClientsAsync(string metric, string aggregate, int windowSeconds, double? threshold = null)
+        {
+            var queryId = Interlocked.Increment(ref _nextQueryId);
+            var queryCommand = $"QUERY:{queryId}:{metric}:{aggregate}:{windowSeconds}";
+            if (threshold.HasValue)
+            {
+                queryCommand += $":{threshold.Value.ToString(System.Globalization.CultureInfo.InvariantCulture)}";
+            }
+            var queryBytes = System.Text.Encoding.ASCII.GetBytes(queryCommand + "\n");
+
+            var sent = await WriteToAllClientsAsync(queryBytes).ConfigureAwait(false);
+            AddLogMessage($"Query {queryId} ({aggregate} of {metric} over {windowSeconds}s) sent to {sent} clients");
+            return queryId;
+        }
+
+        /// <summary>
+        /// Writes the same bytes to every connected client in parallel
+        /// </summary>
+        /// <param name="bytes">The bytes to write</param>
+        /// <returns>The number of clients written to</returns>
+        private async Task<int> WriteToAllClientsAsync(byte[] bytes)
+        {
             TcpClient[] clientsSnapshot;
             lock (_clientsLock)
             {
                 clientsSnapshot = _connectedClients.ToArray();
             }
-            foreach (var client in clientsSnapshot)
-            {
-                try
-                {
-                    if (client.Connected)
-                    {
-                        client.GetStream().Write(updateBytes, 0, updateBytes.Length);
-                        AddLogMessage($"Update command sent to client {((IPEndPoint)client.Client.RemoteEndPoint!).Address}");
-                    }
-                }
-                catch (Exception ex)
-                {
-                    AddLogMessage($"ERROR: Failed to send update to client: {ex.Message}");
-                }
-            }
+
+            var results = await Task.WhenAll(clientsSnapshot.Select(client => WriteToClientAsync(client, bytes))).ConfigureAwait(false);
+            return results.Count(written => written);
         }
 
         /// <summary>
-        /// Sends an update command to a specific client
+        /// Writes bytes to a client. Acknowledgements, pongs and pushed commands share
+        /// one stream and the bot splits it by line, so writes to a client are
+        /// serialized to keep lines from interleaving.
         /// </summary>
-        /// <param name="client">The client to update</param>
-        /// <param name="updateUrl">The URL where the new version can be downloaded</param>
-        public void SendUpdateToClient(TcpClient client, string updateUrl)
+        /// <param name="client">The client to write to</param>
+        /// <param name="bytes">The bytes to write</param>
+        /// <returns>Whether the write succeeded</returns>
+        private async Task<bool> WriteToClientAsync(TcpClient client, byte[] bytes)
         {
+            SemaphoreSlim? writeLock;
+            lock (_clientsLock)
+            {
+                _clientWriteLocks.TryGetValue(client, out writeLock);
+            }
+            if (writeLock == null || !client.Connected)
+            {
+                return false;
+            }
+
+            await writeLock.WaitAsync().ConfigureAwait(false);
             try
             {
-                if (client.Connected)
-                {
-                    var updateCommand = $"UPDATE:{updateUrl}";
-                    var updateBytes = System.Text.Encoding.ASCII.GetBytes(updateCommand);
-                    client.GetStream().Write(updateBytes, 0, updateBytes.Length);
-                    
-                    var clientAddress = ((IPEndPoint)client.Client.RemoteEndPoint!).Address;
-                    AddLogMessage($"Update command sent to specific client {clientAddress}");
-                }
+                await client.GetStream().WriteAsync(bytes, 0, bytes.Length).ConfigureAwait(false);
+                return true;
             }
             catch (Exception ex)
             {
-                AddLogMessage($"ERROR: Failed to send update to specific client: {ex.Message}");
+                AddLogMessage($"ERROR: Failed to write to client: {ex.Message}");
+                return false;
+            }
+            finally
+            {
+                writeLock.Release();
             }
         }
 
@@ -221,6 +278,7 @@ namespace server.Models
                     lock (_clientsLock)
                     {
                         _connectedClients.Add(client);
+                        _clientWriteLocks.Add(client, new SemaphoreSlim(1, 1));
                     }
                     OnClientConnected(client);
                     
@@ -258,12 +316,33 @@ namespace server.Models
                     if (bytesRead == 0) break; // Client disconnected
 
                     var message = System.Text.Encoding.UTF8.GetString(buffer, 0, bytesRead);
-                    AddLogMessage($"Received from client: {message}");
 
-                    // Echo the message back to the client
-                    var response = $"Server received: {message}";
+                    // Link probes are answered immediately and kept out of the log
+                    if (message.StartsWith("PING:"))
+                    {
+                        var pongBytes = System.Text.Encoding.UTF8.GetBytes("PONG:" + message.Substring(5) + "\n");
+                        if (!await WriteToClientAsync(client, pongBytes).ConfigureAwait(false)) break;
+                        continue;
+                    }
+
+                    // Acknowledge the read as one newline-terminated line. The byte count
+                    // lets the bot tell when a message it sent is fully acknowledged,
+                    // since a large message arrives over several reads. Acknowledge
+                    // before logging: logging waits on the UI thread, and a stalled UI
+                    // must not hold up the bots' receive timeouts.
+                    var echo = message.Replace("\r", "").Replace('\n', ' ');
+                    var response = $"Server received ({bytesRead} bytes): {echo}\n";
                     var responseBytes = System.Text.Encoding.UTF8.GetBytes(response);
-                    await stream.WriteAsync(responseBytes, 0, responseBytes.Length).ConfigureAwait(false);
+                    if (!await WriteToClientAsync(client, responseBytes).ConfigureAwait(false)) break;
+
+                    if (message.StartsWith("QUERY_RESULT:"))
+                    {
+                        AddLogMessage($"Query result from {((IPEndPoint)client.Client.RemoteEndPoint!).Address}: {message.Substring(13)}");
+                    }
+                    else
+                    {
+                        AddLogMessage($"Received from client: {message}");
+                    }
                 }
             }
             catch (Exception ex)
@@ -286,6 +365,7 @@ namespace server.Models
             lock (_clientsLock)
             {
                 removed = _connectedClients.Remove(client);
+                _clientWriteLocks.Remove(client);
             }
             if (removed)
             {
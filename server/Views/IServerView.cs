@@ -28,6 +28,11 @@ namespace server.Views
         /// </summary>
         event EventHandler UpdateAllRequested;
 
+        /// <summary>
+        /// Event raised when the user requests to send an aggregate query to all clients
+        /// </summary>
+        event EventHandler<string> QueryAllRequested;
+
         /// <summary>
         /// Updates the server status display
         /// </summary>
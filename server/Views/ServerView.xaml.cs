@@ -30,6 +30,11 @@ namespace server.Views
         /// </summary>
         public event EventHandler? UpdateAllRequested;
 
+        /// <summary>
+        /// Event raised when the user requests to query all clients
+        /// </summary>
+        public event EventHandler<string>? QueryAllRequested;
+
         /// <summary>
         /// Initializes a new instance of the ServerView
         /// </summary>
@@ -42,6 +47,7 @@ namespace server.Views
             ClearLogButton.Click += ClearLogButton_Click;
             CopyLogButton.Click += CopyLogButton_Click;
             UpdateAllButton.Click += UpdateAllButton_Click;
+            QueryAllButton.Click += QueryAllButton_Click;
             
             // Initialize status
             UpdateServerStatus(false);
@@ -95,6 +101,16 @@ namespace server.Views
             UpdateAllRequested?.Invoke(this, EventArgs.Empty);
         }
 
+        /// <summary>
+        /// Handles the query all button click event
+        /// </summary>
+        /// <param name="sender">Event sender</param>
+        /// <param name="e">Event arguments</param>
+        private void QueryAllButton_Click(object sender, RoutedEventArgs e)
+        {
+            QueryAllRequested?.Invoke(this, QueryTextBox.Text.Trim());
+        }
+
         /// <summary>
         /// Updates the server status display
         /// </summary>
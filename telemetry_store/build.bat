@@ -0,0 +1,29 @@
+@echo off
+echo Building Telemetry Store Library...
+
+where g++ >nul 2>nul
+if %errorlevel% equ 0 (
+    g++ -std=c++17 -O2 -shared telemetry_store_api.cpp telemetry_store.cpp time_series.cpp mapped_file.cpp -o telemetry_store.dll
+    if %errorlevel% equ 0 (
+        echo Build successful! Created telemetry_store.dll
+    ) else (
+        echo Build failed!
+    )
+    goto :end
+)
+
+where cl >nul 2>nul
+if %errorlevel% equ 0 (
+    cl telemetry_store_api.cpp telemetry_store.cpp time_series.cpp mapped_file.cpp /std:c++17 /O2 /EHsc /LD /Fe:telemetry_store.dll
+    if %errorlevel% equ 0 (
+        echo Build successful! Created telemetry_store.dll
+    ) else (
+        echo Build failed!
+    )
+    goto :end
+)
+
+echo ERROR: No C++ compiler found! Install MinGW or Visual Studio.
+
+:end
+pause
@@ -0,0 +1,134 @@
+#include "mapped_file.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : data(NULL), length(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(NULL) {
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                             NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fileHandle, &size)) {
+        close();
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        // Empty files cannot be mapped; treat them as open with no data
+        return true;
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappingHandle == NULL) {
+        close();
+        return false;
+    }
+
+    data = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        close();
+        return false;
+    }
+
+    length = (size_t)size.QuadPart;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != NULL) {
+        UnmapViewOfFile(data);
+        data = NULL;
+    }
+    if (mappingHandle != NULL) {
+        CloseHandle(mappingHandle);
+        mappingHandle = NULL;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+    length = 0;
+}
+
+bool MappedFile::isOpen() const {
+    return fileHandle != INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : data(NULL), length(0), fileDescriptor(-1) {
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    fileDescriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fileDescriptor, &info) != 0) {
+        close();
+        return false;
+    }
+    if (info.st_size == 0) {
+        // Empty files cannot be mapped; treat them as open with no data
+        return true;
+    }
+
+    void* mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    data = (const char*)mapping;
+    length = (size_t)info.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != NULL) {
+        munmap((void*)data, length);
+        data = NULL;
+    }
+    if (fileDescriptor >= 0) {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+    }
+    length = 0;
+}
+
+bool MappedFile::isOpen() const {
+    return fileDescriptor >= 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+const char* MappedFile::getData() const {
+    return data;
+}
+
+size_t MappedFile::getSize() const {
+    return length;
+}
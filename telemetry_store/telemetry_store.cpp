@@ -0,0 +1,121 @@
+#include "telemetry_store.h"
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+TelemetryStore::TelemetryStore(const std::string& rootPath, const TelemetryStoreOptions& options)
+    : rootPath(rootPath), options(options), appendCounter(0) {
+    if (this->options.indexInterval == 0) {
+        this->options.indexInterval = 1;
+    }
+    if (this->options.segmentMaxPoints == 0) {
+        this->options.segmentMaxPoints = 1;
+    }
+    if (this->options.maxOpenWriters == 0) {
+        this->options.maxOpenWriters = 1;
+    }
+}
+
+TelemetryStore::~TelemetryStore() {
+    flush();
+}
+
+bool TelemetryStore::append(const std::string& agentId, const std::string& metric, long long timestamp, double value) {
+    std::lock_guard<std::mutex> lock(storeLock);
+    SeriesEntry* entry = getSeries(agentId, metric, true);
+    if (entry == NULL) {
+        return false;
+    }
+    if (!entry->timeSeries->hasOpenWriter()) {
+        closeIdleWriters(options.maxOpenWriters - 1);
+    }
+    entry->lastAppend = ++appendCounter;
+    return entry->timeSeries->append(timestamp, value);
+}
+
+size_t TelemetryStore::scan(const std::string& agentId, const std::string& metric, long long fromTime,
+                            long long toTime, std::vector<TelemetryPoint>& out) {
+    std::lock_guard<std::mutex> lock(storeLock);
+    SeriesEntry* entry = getSeries(agentId, metric, false);
+    return entry != NULL ? entry->timeSeries->scan(fromTime, toTime, out) : 0;
+}
+
+size_t TelemetryStore::downsample(const std::string& agentId, const std::string& metric, long long fromTime,
+                                  long long toTime, long long bucketWidth, std::vector<TelemetryBucket>& out) {
+    std::lock_guard<std::mutex> lock(storeLock);
+    SeriesEntry* entry = getSeries(agentId, metric, false);
+    return entry != NULL ? entry->timeSeries->downsample(fromTime, toTime, bucketWidth, out) : 0;
+}
+
+void TelemetryStore::flush() {
+    std::lock_guard<std::mutex> lock(storeLock);
+    for (auto& entry : series) {
+        entry.second.timeSeries->flush();
+    }
+}
+
+TelemetryStore::SeriesEntry* TelemetryStore::getSeries(const std::string& agentId, const std::string& metric,
+                                                       bool create) {
+    std::string agentName = sanitizeName(agentId);
+    std::string metricName = sanitizeName(metric);
+    std::string key = agentName + "/" + metricName;
+
+    auto it = series.find(key);
+    if (it != series.end()) {
+        return &it->second;
+    }
+
+    fs::path directory = fs::path(rootPath) / agentName / metricName;
+    std::error_code error;
+    if (!create && !fs::exists(directory, error)) {
+        return NULL;
+    }
+
+    std::unique_ptr<TimeSeries> timeSeries(new TimeSeries(directory.string(), options.segmentMaxPoints,
+                                                          options.indexInterval, options.retentionBytes));
+    if (!timeSeries->open()) {
+        return NULL;
+    }
+
+    SeriesEntry& entry = series[key];
+    entry.timeSeries = std::move(timeSeries);
+    entry.lastAppend = 0;
+    return &entry;
+}
+
+void TelemetryStore::closeIdleWriters(size_t keep) {
+    // Least recently appended first. Only runs when a writer is about to be
+    // opened, so the linear scans stay off the common append path.
+    std::vector<SeriesEntry*> open;
+    for (auto& entry : series) {
+        if (entry.second.timeSeries->hasOpenWriter()) {
+            open.push_back(&entry.second);
+        }
+    }
+    if (open.size() <= keep) {
+        return;
+    }
+
+    std::sort(open.begin(), open.end(),
+              [](const SeriesEntry* a, const SeriesEntry* b) { return a->lastAppend < b->lastAppend; });
+    for (size_t i = 0; i < open.size() - keep; i++) {
+        open[i]->timeSeries->closeWriter();
+    }
+}
+
+std::string TelemetryStore::sanitizeName(const std::string& name) {
+    // Agent ids and metric names become directory names
+    std::string result = name.empty() ? "_" : name;
+    for (auto& c : result) {
+        bool allowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                       c == '-' || c == '_' || c == '.';
+        if (!allowed) {
+            c = '_';
+        }
+    }
+    if (result == "." || result == "..") {
+        result = "_";
+    }
+    return result;
+}
@@ -0,0 +1,57 @@
+#ifndef TELEMETRY_STORE_H
+#define TELEMETRY_STORE_H
+
+#include "time_series.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct TelemetryStoreOptions {
+    size_t segmentMaxPoints;            // Points per segment before it is sealed
+    size_t indexInterval;               // Rows between sparse index entries
+    unsigned long long retentionBytes;  // Per-series disk budget, 0 keeps everything
+    size_t maxOpenWriters;              // Series with open writers (3 stdio streams each)
+
+    TelemetryStoreOptions()
+        : segmentMaxPoints(1 << 20), indexInterval(256), retentionBytes(256ULL * 1024 * 1024),
+          maxOpenWriters(128) {
+    }
+};
+
+// Per-agent time-series storage for the ingest side. Series live under
+// <root>/<agent>/<metric>/ and are opened lazily on first use. The MSVC CRT
+// allows 512 stdio streams by default, so only the maxOpenWriters most
+// recently appended series keep their files open.
+class TelemetryStore {
+private:
+    struct SeriesEntry {
+        std::unique_ptr<TimeSeries> timeSeries;
+        unsigned long long lastAppend;
+    };
+
+    std::string rootPath;
+    TelemetryStoreOptions options;
+    std::map<std::string, SeriesEntry> series;
+    unsigned long long appendCounter;
+    std::mutex storeLock;
+
+public:
+    TelemetryStore(const std::string& rootPath, const TelemetryStoreOptions& options = TelemetryStoreOptions());
+    ~TelemetryStore();
+
+    bool append(const std::string& agentId, const std::string& metric, long long timestamp, double value);
+    size_t scan(const std::string& agentId, const std::string& metric, long long fromTime, long long toTime,
+                std::vector<TelemetryPoint>& out);
+    size_t downsample(const std::string& agentId, const std::string& metric, long long fromTime,
+                      long long toTime, long long bucketWidth, std::vector<TelemetryBucket>& out);
+    void flush();
+
+private:
+    SeriesEntry* getSeries(const std::string& agentId, const std::string& metric, bool create);
+    void closeIdleWriters(size_t keep);
+    static std::string sanitizeName(const std::string& name);
+};
+
+#endif // TELEMETRY_STORE_H
@@ -0,0 +1,78 @@
+#include "telemetry_store_api.h"
+#include "telemetry_store.h"
+#include <algorithm>
+#include <climits>
+
+namespace {
+
+int totalCount(size_t count) {
+    return (int)std::min<size_t>(count, INT_MAX);
+}
+
+} // namespace
+
+TelemetryStoreHandle telemetry_store_open(const char* rootPath, unsigned long long retentionBytes) {
+    if (rootPath == NULL) {
+        return NULL;
+    }
+    TelemetryStoreOptions options;
+    options.retentionBytes = retentionBytes;
+    return new TelemetryStore(rootPath, options);
+}
+
+void telemetry_store_close(TelemetryStoreHandle store) {
+    delete store;
+}
+
+int telemetry_store_append(TelemetryStoreHandle store, const char* agentId, const char* metric,
+                           long long timestamp, double value) {
+    if (store == NULL || agentId == NULL || metric == NULL) {
+        return 0;
+    }
+    return store->append(agentId, metric, timestamp, value) ? 1 : 0;
+}
+
+void telemetry_store_flush(TelemetryStoreHandle store) {
+    if (store != NULL) {
+        store->flush();
+    }
+}
+
+int telemetry_store_scan(TelemetryStoreHandle store, const char* agentId, const char* metric,
+                         long long fromTime, long long toTime,
+                         long long* timestamps, double* values, int capacity) {
+    if (store == NULL || agentId == NULL || metric == NULL || capacity < 0) {
+        return 0;
+    }
+
+    std::vector<TelemetryPoint> points;
+    store->scan(agentId, metric, fromTime, toTime, points);
+
+    int count = (int)std::min<size_t>(points.size(), (size_t)capacity);
+    for (int i = 0; i < count; i++) {
+        timestamps[i] = points[i].timestamp;
+        values[i] = points[i].value;
+    }
+    return totalCount(points.size());
+}
+
+int telemetry_store_downsample(TelemetryStoreHandle store, const char* agentId, const char* metric,
+                               long long fromTime, long long toTime, long long bucketWidth,
+                               long long* starts, double* mins, double* maxs, double* averages,
+                               int capacity) {
+    if (store == NULL || agentId == NULL || metric == NULL || capacity < 0) {
+        return 0;
+    }
+
+    std::vector<TelemetryBucket> buckets;
+    store->downsample(agentId, metric, fromTime, toTime, bucketWidth, buckets);
+
+    int count = (int)std::min<size_t>(buckets.size(), (size_t)capacity);
+    for (int i = 0; i < count; i++) {
+        starts[i] = buckets[i].start;
+        mins[i] = buckets[i].min;
+        maxs[i] = buckets[i].max;
+        averages[i] = buckets[i].count > 0 ? buckets[i].sum / buckets[i].count : 0.0;
+    }
+    return totalCount(buckets.size());
+}
@@ -0,0 +1,42 @@
+#ifndef TELEMETRY_STORE_API_H
+#define TELEMETRY_STORE_API_H
+
+// Flat C interface so the .NET server can P/Invoke the store
+
+#ifdef _WIN32
+#define TELEMETRY_API __declspec(dllexport)
+#else
+#define TELEMETRY_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct TelemetryStore* TelemetryStoreHandle;
+
+TELEMETRY_API TelemetryStoreHandle telemetry_store_open(const char* rootPath, unsigned long long retentionBytes);
+TELEMETRY_API void telemetry_store_close(TelemetryStoreHandle store);
+TELEMETRY_API int telemetry_store_append(TelemetryStoreHandle store, const char* agentId, const char* metric,
+                                         long long timestamp, double value);
+TELEMETRY_API void telemetry_store_flush(TelemetryStoreHandle store);
+
+// Copy up to `capacity` points into the caller's arrays and return how many
+// points the range holds. A result larger than `capacity` means the copy was
+// cut short; call again with a larger buffer (capacity 0 just counts).
+TELEMETRY_API int telemetry_store_scan(TelemetryStoreHandle store, const char* agentId, const char* metric,
+                                       long long fromTime, long long toTime,
+                                       long long* timestamps, double* values, int capacity);
+
+// Copy up to `capacity` buckets of `bucketWidth`; returns the total bucket
+// count, with the same truncation rule as telemetry_store_scan
+TELEMETRY_API int telemetry_store_downsample(TelemetryStoreHandle store, const char* agentId, const char* metric,
+                                             long long fromTime, long long toTime, long long bucketWidth,
+                                             long long* starts, double* mins, double* maxs, double* averages,
+                                             int capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TELEMETRY_STORE_API_H
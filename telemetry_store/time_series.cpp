@@ -0,0 +1,418 @@
+#include "time_series.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const unsigned int SUMMARY_MAGIC = 0x31535354; // "TSS1"
+const unsigned int SUMMARY_VERSION = 1;
+
+void resetSummary(SegmentSummary& summary) {
+    summary.magic = SUMMARY_MAGIC;
+    summary.version = SUMMARY_VERSION;
+    summary.count = 0;
+    summary.minTimestamp = std::numeric_limits<long long>::max();
+    summary.maxTimestamp = std::numeric_limits<long long>::min();
+    summary.minValue = std::numeric_limits<double>::infinity();
+    summary.maxValue = -std::numeric_limits<double>::infinity();
+    summary.sum = 0.0;
+}
+
+void addToSummary(SegmentSummary& summary, long long timestamp, double value) {
+    summary.count++;
+    summary.minTimestamp = std::min(summary.minTimestamp, timestamp);
+    summary.maxTimestamp = std::max(summary.maxTimestamp, timestamp);
+    summary.minValue = std::min(summary.minValue, value);
+    summary.maxValue = std::max(summary.maxValue, value);
+    summary.sum += value;
+}
+
+long long bucketStart(long long timestamp, long long bucketWidth) {
+    long long start = timestamp / bucketWidth * bucketWidth;
+    return start > timestamp ? start - bucketWidth : start;
+}
+
+} // namespace
+
+TimeSeries::TimeSeries(const std::string& directory, size_t segmentMaxPoints,
+                       size_t indexInterval, unsigned long long retentionBytes)
+    : directory(directory), segmentMaxPoints(segmentMaxPoints), indexInterval(indexInterval),
+      retentionBytes(retentionBytes), timestampFile(NULL), valueFile(NULL), indexFile(NULL),
+      lastTimestamp(std::numeric_limits<long long>::min()), dirty(false) {
+}
+
+TimeSeries::~TimeSeries() {
+    closeFiles();
+}
+
+bool TimeSeries::open() {
+    std::error_code error;
+    fs::create_directories(directory, error);
+    if (error) {
+        std::cerr << "ERROR: Cannot create series directory " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+
+    // Segments are named by a zero-padded sequence number, so numeric order is time order
+    std::vector<unsigned int> ids;
+    for (const auto& entry : fs::directory_iterator(directory, error)) {
+        std::string stem = entry.path().stem().string();
+        if (entry.path().extension() == ".ts" && !stem.empty() &&
+            stem.find_first_not_of("0123456789") == std::string::npos) {
+            ids.push_back((unsigned int)std::stoul(stem));
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+
+    segments.clear();
+    for (unsigned int id : ids) {
+        Segment segment;
+        segment.id = id;
+        segment.sealed = false;
+
+        FILE* summaryFile = fopen(segmentPath(id, ".sum").c_str(), "rb");
+        if (summaryFile != NULL) {
+            segment.sealed = fread(&segment.summary, sizeof(segment.summary), 1, summaryFile) == 1 &&
+                             segment.summary.magic == SUMMARY_MAGIC &&
+                             segment.summary.version == SUMMARY_VERSION;
+            fclose(summaryFile);
+        }
+
+        if (!segment.sealed && !recoverSegment(segment)) {
+            return false;
+        }
+        if (segment.summary.count > 0) {
+            lastTimestamp = std::max(lastTimestamp, segment.summary.maxTimestamp);
+        }
+        segments.push_back(segment);
+    }
+
+    // Only the newest segment may stay open for appends; seal any others left
+    // unsealed by a crash.
+    for (size_t i = 0; i + 1 < segments.size(); i++) {
+        if (!segments[i].sealed) {
+            FILE* summaryFile = fopen(segmentPath(segments[i].id, ".sum").c_str(), "wb");
+            if (summaryFile != NULL) {
+                fwrite(&segments[i].summary, sizeof(segments[i].summary), 1, summaryFile);
+                fclose(summaryFile);
+            }
+            segments[i].sealed = true;
+        }
+    }
+
+    // Writers are opened by the first append, so a series that is only read
+    // holds no file handles
+    if (segments.empty() || segments.back().sealed) {
+        Segment segment;
+        segment.id = segments.empty() ? 1 : segments.back().id + 1;
+        segment.sealed = false;
+        resetSummary(segment.summary);
+        segments.push_back(segment);
+    }
+    return true;
+}
+
+bool TimeSeries::append(long long timestamp, double value) {
+    if (timestampFile == NULL) {
+        // Not opened yet, or closed by the store to stay under the stdio stream limit
+        if (segments.empty() || segments.back().sealed || !reopenSegment(segments.back())) {
+            return false;
+        }
+    }
+
+    Segment& active = segments.back();
+    if (timestamp < lastTimestamp) {
+        // Columns are kept sorted so the sparse index can be binary searched
+        return false;
+    }
+
+    if (active.summary.count % indexInterval == 0) {
+        IndexEntry entry = { timestamp, active.summary.count };
+        fwrite(&entry, sizeof(entry), 1, indexFile);
+    }
+    fwrite(&timestamp, sizeof(timestamp), 1, timestampFile);
+    fwrite(&value, sizeof(value), 1, valueFile);
+    addToSummary(active.summary, timestamp, value);
+    lastTimestamp = timestamp;
+    dirty = true;
+
+    if (active.summary.count >= segmentMaxPoints) {
+        unsigned int nextId = active.id + 1;
+        if (!sealActiveSegment()) {
+            return false;
+        }
+        enforceRetention();
+        return startSegment(nextId);
+    }
+    return true;
+}
+
+void TimeSeries::flush() {
+    if (dirty) {
+        fflush(timestampFile);
+        fflush(valueFile);
+        fflush(indexFile);
+        dirty = false;
+    }
+}
+
+bool TimeSeries::hasOpenWriter() const {
+    return timestampFile != NULL;
+}
+
+void TimeSeries::closeWriter() {
+    // closeFiles() flushes; the next append reopens the active segment
+    closeFiles();
+}
+
+size_t TimeSeries::scan(long long fromTime, long long toTime, std::vector<TelemetryPoint>& out) {
+    flush();
+    size_t before = out.size();
+
+    for (const Segment& segment : segments) {
+        if (segment.summary.count == 0 || segment.summary.maxTimestamp < fromTime ||
+            segment.summary.minTimestamp >= toTime) {
+            continue;
+        }
+        readRows(segment, fromTime, toTime, &out, NULL, 0);
+    }
+    return out.size() - before;
+}
+
+size_t TimeSeries::downsample(long long fromTime, long long toTime, long long bucketWidth,
+                              std::vector<TelemetryBucket>& out) {
+    if (bucketWidth <= 0) {
+        return 0;
+    }
+    flush();
+    size_t before = out.size();
+
+    for (const Segment& segment : segments) {
+        const SegmentSummary& summary = segment.summary;
+        if (summary.count == 0 || summary.maxTimestamp < fromTime || summary.minTimestamp >= toTime) {
+            continue;
+        }
+
+        // A segment inside the query window that falls in a single bucket is
+        // answered from its summary without touching the columns.
+        long long start = bucketStart(summary.minTimestamp, bucketWidth);
+        if (summary.minTimestamp >= fromTime && summary.maxTimestamp < toTime &&
+            start == bucketStart(summary.maxTimestamp, bucketWidth)) {
+            addToBucket(out, start, summary.minValue, summary.maxValue, summary.sum, summary.count);
+            continue;
+        }
+
+        readRows(segment, fromTime, toTime, NULL, &out, bucketWidth);
+    }
+    return out.size() - before;
+}
+
+unsigned long long TimeSeries::getPointCount() const {
+    unsigned long long count = 0;
+    for (const Segment& segment : segments) {
+        count += segment.summary.count;
+    }
+    return count;
+}
+
+unsigned long long TimeSeries::getDiskUsage() const {
+    unsigned long long bytes = 0;
+    for (const Segment& segment : segments) {
+        bytes += segmentBytes(segment);
+    }
+    return bytes;
+}
+
+std::string TimeSeries::segmentPath(unsigned int id, const char* extension) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%010u%s", id, extension);
+    return (fs::path(directory) / name).string();
+}
+
+bool TimeSeries::startSegment(unsigned int id) {
+    Segment segment;
+    segment.id = id;
+    segment.sealed = false;
+    resetSummary(segment.summary);
+    segments.push_back(segment);
+    return reopenSegment(segment);
+}
+
+bool TimeSeries::reopenSegment(const Segment& segment) {
+    closeFiles();
+    timestampFile = fopen(segmentPath(segment.id, ".ts").c_str(), "ab");
+    valueFile = fopen(segmentPath(segment.id, ".val").c_str(), "ab");
+    indexFile = fopen(segmentPath(segment.id, ".idx").c_str(), "ab");
+
+    if (timestampFile == NULL || valueFile == NULL || indexFile == NULL) {
+        std::cerr << "ERROR: Cannot open segment " << segment.id << " in " << directory << std::endl;
+        closeFiles();
+        return false;
+    }
+    return true;
+}
+
+bool TimeSeries::sealActiveSegment() {
+    closeFiles();
+
+    Segment& active = segments.back();
+    FILE* summaryFile = fopen(segmentPath(active.id, ".sum").c_str(), "wb");
+    if (summaryFile == NULL) {
+        std::cerr << "ERROR: Cannot write summary for segment " << active.id << std::endl;
+        return false;
+    }
+    bool written = fwrite(&active.summary, sizeof(active.summary), 1, summaryFile) == 1;
+    fclose(summaryFile);
+
+    active.sealed = written;
+    return written;
+}
+
+bool TimeSeries::recoverSegment(Segment& segment) {
+    // Rebuild the summary and sparse index from the columns and drop a torn
+    // trailing row. The old index may point past the surviving rows, and
+    // appending after such an entry would leave the index out of order.
+    resetSummary(segment.summary);
+
+    MappedFile timestamps, values;
+    if (!timestamps.open(segmentPath(segment.id, ".ts")) || !values.open(segmentPath(segment.id, ".val"))) {
+        std::cerr << "ERROR: Cannot read segment " << segment.id << " in " << directory << std::endl;
+        return false;
+    }
+
+    size_t rows = std::min(timestamps.getSize() / sizeof(long long), values.getSize() / sizeof(double));
+    const long long* timestampColumn = (const long long*)timestamps.getData();
+    const double* valueColumn = (const double*)values.getData();
+    std::vector<IndexEntry> indexEntries;
+    for (size_t row = 0; row < rows; row++) {
+        if (row % indexInterval == 0) {
+            IndexEntry entry = { timestampColumn[row], row };
+            indexEntries.push_back(entry);
+        }
+        addToSummary(segment.summary, timestampColumn[row], valueColumn[row]);
+    }
+
+    bool torn = timestamps.getSize() != rows * sizeof(long long) || values.getSize() != rows * sizeof(double);
+    timestamps.close();
+    values.close();
+
+    if (torn) {
+        std::error_code error;
+        fs::resize_file(segmentPath(segment.id, ".ts"), rows * sizeof(long long), error);
+        fs::resize_file(segmentPath(segment.id, ".val"), rows * sizeof(double), error);
+    }
+
+    FILE* indexFile = fopen(segmentPath(segment.id, ".idx").c_str(), "wb");
+    if (indexFile == NULL) {
+        std::cerr << "ERROR: Cannot rebuild index for segment " << segment.id << " in " << directory << std::endl;
+        return false;
+    }
+    bool written = indexEntries.empty() ||
+                   fwrite(indexEntries.data(), sizeof(IndexEntry), indexEntries.size(), indexFile) == indexEntries.size();
+    fclose(indexFile);
+    return written;
+}
+
+void TimeSeries::closeFiles() {
+    if (timestampFile != NULL) {
+        fclose(timestampFile);
+        timestampFile = NULL;
+    }
+    if (valueFile != NULL) {
+        fclose(valueFile);
+        valueFile = NULL;
+    }
+    if (indexFile != NULL) {
+        fclose(indexFile);
+        indexFile = NULL;
+    }
+    dirty = false;
+}
+
+void TimeSeries::enforceRetention() {
+    // Whole sealed segments are dropped oldest first; the active one is never removed
+    unsigned long long total = getDiskUsage();
+    while (retentionBytes > 0 && total > retentionBytes && segments.size() > 1 && segments.front().sealed) {
+        const Segment& oldest = segments.front();
+        total -= segmentBytes(oldest);
+
+        std::error_code error;
+        const char* extensions[] = { ".ts", ".val", ".idx", ".sum" };
+        for (const char* extension : extensions) {
+            fs::remove(segmentPath(oldest.id, extension), error);
+        }
+        segments.erase(segments.begin());
+    }
+}
+
+unsigned long long TimeSeries::segmentBytes(const Segment& segment) const {
+    unsigned long long rows = segment.summary.count;
+    unsigned long long indexEntries = (rows + indexInterval - 1) / indexInterval;
+    return rows * (sizeof(long long) + sizeof(double)) + indexEntries * sizeof(IndexEntry) +
+           (segment.sealed ? sizeof(SegmentSummary) : 0);
+}
+
+bool TimeSeries::readRows(const Segment& segment, long long fromTime, long long toTime,
+                          std::vector<TelemetryPoint>* points, std::vector<TelemetryBucket>* buckets,
+                          long long bucketWidth) {
+    MappedFile timestamps, values, index;
+    if (!timestamps.open(segmentPath(segment.id, ".ts")) || !values.open(segmentPath(segment.id, ".val"))) {
+        return false;
+    }
+
+    size_t rows = std::min(timestamps.getSize() / sizeof(long long), values.getSize() / sizeof(double));
+    const long long* timestampColumn = (const long long*)timestamps.getData();
+    const double* valueColumn = (const double*)values.getData();
+
+    // The sparse index narrows the start to within indexInterval rows
+    size_t row = 0;
+    if (fromTime > segment.summary.minTimestamp && index.open(segmentPath(segment.id, ".idx"))) {
+        const IndexEntry* entries = (const IndexEntry*)index.getData();
+        size_t entryCount = index.getSize() / sizeof(IndexEntry);
+        const IndexEntry* found = std::lower_bound(entries, entries + entryCount, fromTime,
+            [](const IndexEntry& entry, long long value) { return entry.timestamp < value; });
+        if (found != entries) {
+            row = (size_t)std::min<unsigned long long>((found - 1)->row, rows);
+        }
+    }
+
+    for (; row < rows; row++) {
+        long long timestamp = timestampColumn[row];
+        if (timestamp < fromTime) {
+            continue;
+        }
+        if (timestamp >= toTime) {
+            break;
+        }
+
+        if (points != NULL) {
+            TelemetryPoint point = { timestamp, valueColumn[row] };
+            points->push_back(point);
+        } else {
+            double value = valueColumn[row];
+            addToBucket(*buckets, bucketStart(timestamp, bucketWidth), value, value, value, 1);
+        }
+    }
+    return true;
+}
+
+void TimeSeries::addToBucket(std::vector<TelemetryBucket>& buckets, long long start,
+                             double min, double max, double sum, unsigned long long count) {
+    // Rows arrive in time order, so only the last bucket can still be open
+    if (buckets.empty() || buckets.back().start != start) {
+        TelemetryBucket bucket = { start, min, max, sum, count };
+        buckets.push_back(bucket);
+        return;
+    }
+
+    TelemetryBucket& bucket = buckets.back();
+    bucket.min = std::min(bucket.min, min);
+    bucket.max = std::max(bucket.max, max);
+    bucket.sum += sum;
+    bucket.count += count;
+}
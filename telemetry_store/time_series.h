@@ -0,0 +1,94 @@
+#ifndef TIME_SERIES_H
+#define TIME_SERIES_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct TelemetryPoint {
+    long long timestamp;
+    double value;
+};
+
+struct TelemetryBucket {
+    long long start;
+    double min;
+    double max;
+    double sum;
+    unsigned long long count;
+};
+
+// Written next to each segment when it is sealed, and kept in memory for the
+// active one, so range queries can skip or fold whole segments unread.
+struct SegmentSummary {
+    unsigned int magic;
+    unsigned int version;
+    unsigned long long count;
+    long long minTimestamp;
+    long long maxTimestamp;
+    double minValue;
+    double maxValue;
+    double sum;
+};
+
+// Sparse time index: one entry every indexInterval rows
+struct IndexEntry {
+    long long timestamp;
+    unsigned long long row;
+};
+
+// One append-only series stored as numbered segments. Each segment is a pair
+// of column files (.ts int64 timestamps, .val doubles) plus a sparse .idx
+// index and, once sealed, a .sum summary.
+class TimeSeries {
+private:
+    struct Segment {
+        unsigned int id;
+        SegmentSummary summary;
+        bool sealed;
+    };
+
+    std::string directory;
+    size_t segmentMaxPoints;
+    size_t indexInterval;
+    unsigned long long retentionBytes;
+    std::vector<Segment> segments;      // Oldest first; the last one is active unless sealed
+    FILE* timestampFile;                // Writers for the active segment; NULL while closed
+    FILE* valueFile;
+    FILE* indexFile;
+    long long lastTimestamp;
+    bool dirty;
+
+public:
+    TimeSeries(const std::string& directory, size_t segmentMaxPoints,
+               size_t indexInterval, unsigned long long retentionBytes);
+    ~TimeSeries();
+
+    bool open();
+    bool append(long long timestamp, double value);
+    void flush();
+    bool hasOpenWriter() const;
+    void closeWriter();
+    size_t scan(long long fromTime, long long toTime, std::vector<TelemetryPoint>& out);
+    size_t downsample(long long fromTime, long long toTime, long long bucketWidth,
+                      std::vector<TelemetryBucket>& out);
+    unsigned long long getPointCount() const;
+    unsigned long long getDiskUsage() const;
+
+private:
+    std::string segmentPath(unsigned int id, const char* extension) const;
+    bool startSegment(unsigned int id);
+    bool reopenSegment(const Segment& segment);
+    bool sealActiveSegment();
+    bool recoverSegment(Segment& segment);
+    void closeFiles();
+    void enforceRetention();
+    unsigned long long segmentBytes(const Segment& segment) const;
+    bool readRows(const Segment& segment, long long fromTime, long long toTime,
+                  std::vector<TelemetryPoint>* points, std::vector<TelemetryBucket>* buckets,
+                  long long bucketWidth);
+    static void addToBucket(std::vector<TelemetryBucket>& buckets, long long start,
+                            double min, double max, double sum, unsigned long long count);
+};
+
+#endif // TIME_SERIES_H